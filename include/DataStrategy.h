@@ -16,8 +16,6 @@
 
 #include "ExperimentSetup.h"
 
-using Random = effolkronium::random_static;
-
 namespace sam {
 
 class Experiment;
@@ -66,15 +64,23 @@ public:
   genNewObservationsForAllGroups(Experiment *experiment, int n_new_obs) = 0;
 
   ///
-  /// @brief Generate `n_new_obs` new observations for `g` group.
+  /// @brief Generates `n_new_obs` new observations for groups in [begin, end)
+  ///
+  /// Column `g - begin` of `out` holds the new observations of group `g`, so
+  /// each group's observations are contiguous.
+  ///
+  /// @note The default implementation draws every group, and only keeps the
+  /// requested ones. Strategies whose groups are independent of each other
+  /// only need to draw the requested groups.
   ///
   /// @param experiment The pointer to the experiment
-  /// @param g The target group
+  /// @param begin The first target group
+  /// @param end One past the last target group
   /// @param n_new_obs The number of new observations
-  ///
-  /// @return An array of new observations for group `g`
-//  virtual arma::Row<float> genNewObservationsFor(Experiment *experiment, int g,
-//                                                  int n_new_obs) = 0;
+  /// @param out The new observations, one column per target group
+  virtual void genNewObservationsFor(Experiment *experiment, int begin,
+                                     int end, int n_new_obs,
+                                     arma::Mat<float> &out);
 };
 
 /// @brief Linear Model Data Strategy
@@ -116,7 +122,11 @@ public:
   LinearModelStrategy() = default;
 
   explicit LinearModelStrategy(const Parameters p)
-      : params(p) {};
+      : params(p) {
+    if (params.tau2 != 0.) {
+      random_effects = RandomEffects{params.means.t(), std::sqrt(params.tau2)};
+    }
+  };
 
   void genData(Experiment *experiment) override;
 
@@ -124,8 +134,26 @@ public:
   genNewObservationsForAllGroups(Experiment *experiment,
                                  int n_new_obs) override;
 
+  void genNewObservationsFor(Experiment *experiment, int begin, int end,
+                             int n_new_obs, arma::Mat<float> &out) override;
+
 private:
   Parameters params;
+
+  /// @brief The random-effects model, prepared once when tau2 != 0
+  ///
+  /// The group means are drawn from N(means, tau2 I), and the observations
+  /// from N(noisy means, I); so, the factors of both covariances are diagonal,
+  /// and they reduce to `stddev` and 1.
+  struct RandomEffects {
+    arma::Col<float> means;
+    float stddev;
+  };
+  std::optional<RandomEffects> random_effects;
+
+  /// Replaces the treatment groups' rows of the sample with draws from the
+  /// random-effects model
+  void drawRandomEffects(Experiment *experiment, arma::Mat<float> &sample);
 };
 
 // JSON Parser for LinearModelStrategy::Parameters
@@ -260,34 +288,41 @@ public:
   genNewObservationsForAllGroups(Experiment *experiment,
                                  int n_new_obs) override;
 
+  void genNewObservationsFor(Experiment *experiment, int begin, int end,
+                             int n_new_obs, arma::Mat<float> &out) override;
+
 
 private:
   Parameters params;
 
-  /// Improvement: This can be replaced by `Random::get<bool>` but I need to
-  /// test it first.
-  UnivariateDistribution uniform_dist = std::uniform_real_distribution<>{};
+  //! Item difficulties
+  arma::Mat<float> betas;
 
-  arma::Mat<float> poa;        //! probability of answering
-  arma::umat responses; //! responses to items, binary
-  arma::Col<float> scores;     //! scores of each item
+  //! exp(β) of every item, and category, stored item by item
+  std::vector<float> exp_betas;
 
-  arma::Mat<float> urand;
+  //! One uniform draw per subject and item
+  std::vector<float> uniforms;
 
-  //! Item difficulties
-  arma::Mat<float> betas;
+  ///
+  /// @brief      Prepares #exp_betas from the current #betas
+  ///
+  void cacheDifficulties();
 
-  //! Participants abilities
-  arma::Mat<float> thetas;
-  
   ///
   /// @brief      [Rasch Response Function](https://en.wikipedia.org/wiki/Rasch_model)
   ///
-  /// @param[in]  theta  Indicates the participant's ability, θ
+  /// Scores `n` participants at once. Within an item, the participant passes
+  /// the category `k` with probability `p_k = 1 / (1 + exp(β_k - θ))`, and
+  /// only if they have passed all the previous ones. So, the item score is
+  /// found by comparing one uniform draw with the cumulative products of p_k,
+  /// stopping at the first category that has not been reached.
   ///
-  /// @return     Sum score of `j`th participant over all items
+  /// @param[in]  thetas  Participants' abilities, θ
+  /// @param[in]  n       Number of participants
+  /// @param[out] out     Sum scores of participants over all items
   ///
-  float rasch_score(const float theta);
+  void rasch_scores(const float *thetas, std::size_t n, float *out);
 };
 
 // JSON Parser for GRMDataStrategy::Parameters
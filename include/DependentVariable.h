@@ -14,8 +14,13 @@
 #ifndef SAMPP_DEPENDENTVARIABLE_H
 #define SAMPP_DEPENDENTVARIABLE_H
 
+#include "MeasurementArena.h"
 #include "sam.h"
 #include <fmt/format.h>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <utility>
 
 namespace sam {
 
@@ -30,8 +35,112 @@ enum class HackingMethod;
 /// keeping track of true nobs, mean, and std values.
 class DependentVariable {
 
+  ///
+  /// @brief  A non-owning row over the memory of a MeasurementBuffer
+  ///
+  /// Copies of a view are viewing the same memory, which is safe as long as
+  /// they are being copied along with their buffer.
+  ///
+  class View {
+    std::optional<arma::Row<float>> row_;
+
+  public:
+    View() = default;
+
+    View(const View &other) { *this = other; }
+
+    View &operator=(const View &other) {
+      if (this != &other) {
+        if (other.row_) {
+          set(const_cast<float *>(other.row_->memptr()), other.row_->n_elem);
+        } else {
+          row_.reset();
+        }
+      }
+      return *this;
+    }
+
+    /// Points the view to the first n values of data, the Row object itself
+    /// is only being replaced if the view has actually changed
+    void set(float *data, std::size_t n) {
+      if (!row_ || row_->memptr() != data || row_->n_elem != n) {
+        row_.emplace(data, n, false, true);
+      }
+    }
+
+    void reset() { row_.reset(); }
+
+    explicit operator bool() const { return row_.has_value(); }
+
+    [[nodiscard]] std::size_t size() const { return row_ ? row_->n_elem : 0; }
+
+    arma::Row<float> &operator*() { return *row_; }
+    const arma::Row<float> &operator*() const { return *row_; }
+  };
+
   //! Raw Measurements
-  arma::Row<float> measurements_;
+  //!
+  //! The buffer is shared between copies of a dependent variable, and it will
+  //! only be copied when one of them asks for a mutable access to it, see
+  //! measurements(). This makes copying an Experiment, or a Submission cheap.
+  //! Buffers are coming from the MeasurementArena of the thread, and they have
+  //! some room for the observations that will be added by hacking strategies.
+  MeasurementBuffer buffer_;
+
+  //! The measurements, i.e., a view over the first values of buffer_. It
+  //! covers the whole buffer unless a prefix is being viewed, see viewPrefix().
+  View view_;
+
+  //! Indicates whether view_ is only a prefix of buffer_
+  bool is_viewing_prefix_{false};
+
+  /// Makes sure that this dependent variable is the sole owner of a buffer
+  /// that can hold at least n values, while keeping the viewed values
+  void reserve(std::size_t n);
+
+  /// Makes sure that this dependent variable is the sole owner of its buffer
+  ///
+  /// @note If the dependent variable is viewing a prefix of its buffer, the
+  /// rest of the buffer will be dropped.
+  arma::Row<float> &detach() {
+    reserve(view_.size());
+    view_.set(buffer_.data(), buffer_.size());
+    return *view_;
+  }
+
+  /** @name Running Statistics
+   *  Sufficient statistics of the measurements, i.e., (nobs_, sum, M2). They are
+   *  being updated in O(k) when k values are added or removed, and they are
+   *  invalidated whenever the buffer is handed out for writing.
+   */
+  ///@{
+  double sum_{0};
+  double m2_{0};
+  bool is_stats_synced_{false};
+  ///@}
+
+  //! Indicates whether the measurements have been changed since the last time
+  //! the Experiment evaluated this dependent variable
+  bool is_dirty_{true};
+
+  /// Returns a mutable buffer, and invalidates the running statistics
+  ///
+  /// @note An empty view has no values to be written, so, the statistics of
+  /// a dependent variable whose measurements have been released stay valid.
+  arma::Row<float> &mutate() {
+    if (view_.size() > 0) {
+      is_stats_synced_ = false;
+    }
+    return detach();
+  }
+
+  /// Merges, or removes (if sign < 0), the given values into the running
+  /// statistics
+  void accumulate(const float *values, std::size_t n, int sign);
+
+  void accumulate(const arma::Row<float> &values, int sign) {
+    accumulate(values.memptr(), values.n_elem, sign);
+  }
 
 public:
   //! Dependent variable's ID. This is being used by Policy to perform some
@@ -91,9 +200,9 @@ public:
 
   DependentVariable() = default;
 
-  explicit DependentVariable(const arma::Row<float> &data) : measurements_{data} {
+  explicit DependentVariable(const arma::Row<float> &data) {
+    setMeasurements(data);
     updateStats();
-    true_nobs_ = nobs_;
   };
   
   /// Sets the hacking status
@@ -123,66 +232,105 @@ public:
   [[nodiscard]] bool isCandidate() const {
     return is_candidate_;
   }
+
+  /// Indicates whether the statistics, effects, and tests of this dependent
+  /// variable might be out of date
+  [[nodiscard]] bool isDirty() const {
+    return is_dirty_;
+  }
+
+  /// Marks the dependent variable as evaluated
+  void markClean() {
+    is_dirty_ = false;
+  }
   ///@}
 
   /// Getter / Setter
 
-  arma::Row<float> &measurements() { return measurements_; };
-  const arma::Row<float> &measurements() const { return measurements_; };
+  /// Returns a mutable reference to the measurements, this will copy the
+  /// buffer if it's being shared with another dependent variable.
+  ///
+  /// @note Since the caller may change the values, the next call to
+  /// updateStats() will recompute the statistics from scratch.
+  arma::Row<float> &measurements() { return mutate(); };
+  const arma::Row<float> &measurements() const {
+    static const arma::Row<float> empty;
+    return view_ ? *view_ : empty;
+  };
 
-  /// Sets the raw measurements values
-  void setMeasurements(const arma::Row<float>& meas) {
-    measurements_ = meas;
-    nobs_ = meas.size();
-    
-    // We are basically redefining the values here
-    true_nobs_ = nobs_;
+  /// Drops the raw measurements while keeping all the statistics. The running
+  /// statistics stay valid, so, a later updateStats() reproduces the same values.
+  void releaseMeasurements() {
+    view_.reset();
+    buffer_.reset();
+    is_viewing_prefix_ = false;
   }
 
+  /// Returns the capacity of a new buffer for n values, leaving some room for
+  /// the observations that might be added during the hacking
+  static std::size_t capacityFor(std::size_t n) { return n + n / 2; }
+
+  /// Restricts the measurements to the first n values of the buffer
+  void viewPrefix(int n);
+
+  /// Indicates whether the dependent variable is viewing a prefix of its buffer
+  [[nodiscard]] bool isViewingPrefix() const {
+    return is_viewing_prefix_;
+  }
+
+  /// Indicates whether the buffer is shared with another dependent variable
+  [[nodiscard]] bool isSharingMeasurements() const {
+    return buffer_.use_count() > 1;
+  }
+
+  /// Sets the raw measurements values
+  void setMeasurements(const arma::Row<float>& meas);
+
   /// Adds new measurements to the currently available data
+  ///
+  /// @note The new measurements shouldn't be a view of this dependent
+  /// variable's own measurements.
   void addNewMeasurements(const arma::Row<float>& new_meas) {
-    measurements_.insert_cols(nobs_, new_meas);
-    n_added_obs += new_meas.n_elem;
-    
-    // Keeping the stats up to date
-    updateStats();
+    addNewMeasurements(new_meas.memptr(), new_meas.n_elem);
   }
 
+  /// Adds k new measurements, stored contiguously at values, to the currently
+  /// available data
+  void addNewMeasurements(const float *values, std::size_t k);
+
   /// Removes the measurements by their indices
-  void removeMeasurements(const arma::uvec &idxs) {
-    measurements_.shed_cols(idxs);
-    n_removed_obs += idxs.n_elem;
-    
-    // Keeping the stats up to date
-    updateStats();
-  }
+  void removeMeasurements(const arma::uvec &idxs);
 
   /// Updates the descriptive statistics of the dependent variable
   void updateStats();
 
+  /// Recomputes the descriptive statistics, and the running statistics, from
+  /// the raw measurements
+  void recomputeStats();
+
   /// Reset the internal state of the dependent variable
   void clear();
   
   /** @name STL-like default operators, and methods
    */
   ///@{
-  auto begin() { return measurements_.begin(); };
-  auto end() { return measurements_.end(); };
+  auto begin() { return mutate().begin(); };
+  auto end() { return mutate().end(); };
   
   float &operator[](std::size_t idx) {
-    if (idx > measurements_.size()) {
+    if (idx > measurements().size()) {
       throw std::invalid_argument("Index out of bound.");
     }
     
-    return measurements_(idx);
+    return mutate()(idx);
   }
   
   const float &operator[](std::size_t idx) const {
-    if (idx > measurements_.size()) {
+    if (idx > measurements().size()) {
       throw std::invalid_argument("Index out of bound.");
     }
     
-    return measurements_(idx);
+    return measurements()(idx);
   }
   ///@}
   
@@ -220,6 +368,18 @@ namespace fmt {
     }
   };
 
+  /// Policies are filtering views of the dependent variables, see
+  /// PolicyChain::operator()(Experiment &)
+  template <>
+  struct formatter<std::reference_wrapper<sam::DependentVariable>>
+      : formatter<sam::DependentVariable> {
+    template <typename FormatContext>
+    auto format(std::reference_wrapper<sam::DependentVariable> dv,
+                FormatContext &ctx) const {
+      return formatter<sam::DependentVariable>::format(dv.get(), ctx);
+    }
+  };
+
 }
 
 #endif // SAMPP_DEPENDENTVARIABLE_H
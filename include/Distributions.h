@@ -17,7 +17,14 @@
 #ifndef SAMPP_UTILITIES_H
 #define SAMPP_UTILITIES_H
 
-#include "effolkronium/random.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <random>
+#include <type_traits>
+
+#include "RandomContext.h"
 #include "sam.h"
 
 #include "baaraan/dists/mvnorm_distribution.h"
@@ -60,19 +67,245 @@ const std::map<std::string, std::vector<std::string>> multivariate_dists {
 
 }
 
-using Random = effolkronium::random_static;
+using Generator = sam::Xoshiro256;
+
+/// @brief Fills the buffer with n draws from the standard normal distribution
+///
+/// @ingroup DistributionBuilders
+void fillStandardNormal(Generator &gen, float *out, std::size_t n);
+
+/** @name Bulk Sampling
+ *
+ *  Fill a contiguous buffer with draws from a univariate distribution. The
+ *  generic version draws one value at a time, and the overloads provide faster
+ *  bulk generators for some distributions.
+ *
+ *  @ingroup DistributionBuilders
+ */
+///@{
+template <class Distribution>
+void fillSamples(Distribution &dist, Generator &gen, float *out, std::size_t n) {
+  for (std::size_t i{0}; i < n; ++i) {
+    out[i] = static_cast<float>(dist(gen));
+  }
+}
+
+template <class T>
+void fillSamples(std::normal_distribution<T> &dist, Generator &gen, float *out,
+                 std::size_t n) {
+  fillStandardNormal(gen, out, n);
+  const auto mean = static_cast<float>(dist.mean());
+  const auto stddev = static_cast<float>(dist.stddev());
+  for (std::size_t i{0}; i < n; ++i) {
+    out[i] = mean + stddev * out[i];
+  }
+}
+
+///@}
+
+/// @brief Returns a factor, L, of the covariance matrix such that L L' = sigma
+///
+/// The Cholesky factor is being used if sigma is positive definite; otherwise,
+/// e.g., if sigma is singular, the factor is built from its eigen-decomposition,
+/// with the (numerically) negative eigenvalues treated as zero.
+///
+/// @ingroup DistributionBuilders
+arma::Mat<float> covarianceFactor(const arma::Mat<float> &sigma);
+
+/** @name Bulk Samplers of Multivariate Distributions
+ *
+ *  A bulk sampler fills every column of a matrix with one draw of its
+ *  distribution. Samplers are being built once, along with their distribution
+ *  wrapper; so, they can keep whatever that doesn't change between the draws.
+ *
+ *  @ingroup DistributionBuilders
+ */
+///@{
+template <class Distribution> struct BulkSampler {
+  explicit BulkSampler(const Distribution &) {}
+
+  void fill(Distribution &mdist, Generator &gen, arma::Mat<float> &out) const {
+    out.each_col([&](arma::Col<float> &v) { v = mdist(gen); });
+  }
+};
+
+/// Draws the standard normals of all columns at once, and then correlates them
+/// using one matrix product with the precomputed factor of sigma
+template <class T> struct BulkSampler<baaraan::mvnorm_distribution<T>> {
+  arma::Mat<float> factor;
+  arma::Col<float> means;
+
+  explicit BulkSampler(const baaraan::mvnorm_distribution<T> &mdist)
+      : factor(covarianceFactor(arma::Mat<float>(mdist.sigma()))),
+        means(mdist.means()) {}
+
+  void fill(baaraan::mvnorm_distribution<T> &, Generator &gen,
+            arma::Mat<float> &out) const {
+    fillStandardNormal(gen, out.memptr(), out.n_elem);
+    out = factor * out;
+    out.each_col() += means;
+  }
+};
+///@}
 
 /** @name Distributions' Wrapper
  *
  *  These wrap the Univariate and Multivariate distributions to a function with a given,
- *  ie. std::mt19937, generator. This
+ *  ie. Xoshiro256, generator. In addition to drawing one value, or column, they
+ *  are able to fill a whole buffer in one virtual call, see fillSamples().
+ *
+ *  Some distributions are stateful, e.g., `std::normal_distribution` caches the
+ *  second value of its Box-Muller pair. Since the wrappers are living across
+ *  simulations, each of them restores its distribution to its initial state
+ *  as soon as it's being used after the RandomContext of the thread has been
+ *  reseeded; so, the draws of a simulation don't depend on the simulations
+ *  that ran before it.
  *
  *  @ingroup DistributionBuilders
  */
 ///@{
-using Generator = std::mt19937;
-using UnivariateDistribution = std::function<float(Generator &)>;
-using MultivariateDistribution = std::function<arma::Mat<float>(Generator &)>;
+class UnivariateDistribution {
+
+  struct Concept {
+    virtual ~Concept() = default;
+    virtual float sample(Generator &gen) = 0;
+    virtual void fill(Generator &gen, float *out, std::size_t n) = 0;
+    [[nodiscard]] virtual std::unique_ptr<Concept> clone() const = 0;
+  };
+
+  template <class Distribution> struct Model final : Concept {
+    Distribution initial;
+    std::optional<Distribution> dist;
+    std::uint64_t epoch{0};
+
+    explicit Model(Distribution d) : initial(std::move(d)) {}
+
+    /// Restarts the distribution if the context has been reseeded
+    Distribution &current() {
+      const auto e = sam::RandomContext::local().epoch();
+      if (e != epoch || !dist) {
+        dist.emplace(initial);
+        epoch = e;
+      }
+      return *dist;
+    }
+
+    float sample(Generator &gen) override {
+      return static_cast<float>(current()(gen));
+    }
+
+    void fill(Generator &gen, float *out, std::size_t n) override {
+      fillSamples(current(), gen, out, n);
+    }
+
+    [[nodiscard]] std::unique_ptr<Concept> clone() const override {
+      return std::make_unique<Model>(*this);
+    }
+  };
+
+  std::unique_ptr<Concept> self_;
+
+public:
+  UnivariateDistribution() = default;
+
+  template <class Distribution,
+            class = std::enable_if_t<
+                !std::is_same_v<std::decay_t<Distribution>, UnivariateDistribution> &&
+                std::is_invocable_r_v<float, std::decay_t<Distribution> &, Generator &>>>
+  UnivariateDistribution(Distribution &&dist)
+      : self_(std::make_unique<Model<std::decay_t<Distribution>>>(
+            std::forward<Distribution>(dist))) {}
+
+  UnivariateDistribution(const UnivariateDistribution &other)
+      : self_(other.self_ ? other.self_->clone() : nullptr) {}
+
+  UnivariateDistribution(UnivariateDistribution &&) noexcept = default;
+
+  UnivariateDistribution &operator=(UnivariateDistribution other) noexcept {
+    self_ = std::move(other.self_);
+    return *this;
+  }
+
+  explicit operator bool() const { return static_cast<bool>(self_); }
+
+  /// Draws one value
+  float operator()(Generator &gen) { return self_->sample(gen); }
+
+  /// Fills the buffer with n draws
+  void fill(Generator &gen, float *out, std::size_t n) {
+    self_->fill(gen, out, n);
+  }
+};
+
+class MultivariateDistribution {
+
+  struct Concept {
+    virtual ~Concept() = default;
+    virtual arma::Mat<float> sample(Generator &gen) = 0;
+    virtual void fill(Generator &gen, arma::Mat<float> &out) = 0;
+    [[nodiscard]] virtual std::unique_ptr<Concept> clone() const = 0;
+  };
+
+  template <class Distribution> struct Model final : Concept {
+    Distribution initial;
+    std::optional<Distribution> dist;
+    std::uint64_t epoch{0};
+    BulkSampler<Distribution> sampler;
+
+    explicit Model(Distribution d) : initial(std::move(d)), sampler(initial) {}
+
+    /// Restarts the distribution if the context has been reseeded
+    Distribution &current() {
+      const auto e = sam::RandomContext::local().epoch();
+      if (e != epoch || !dist) {
+        dist.emplace(initial);
+        epoch = e;
+      }
+      return *dist;
+    }
+
+    arma::Mat<float> sample(Generator &gen) override { return current()(gen); }
+
+    void fill(Generator &gen, arma::Mat<float> &out) override {
+      sampler.fill(current(), gen, out);
+    }
+
+    [[nodiscard]] std::unique_ptr<Concept> clone() const override {
+      return std::make_unique<Model>(*this);
+    }
+  };
+
+  std::unique_ptr<Concept> self_;
+
+public:
+  MultivariateDistribution() = default;
+
+  template <class Distribution,
+            class = std::enable_if_t<
+                !std::is_same_v<std::decay_t<Distribution>, MultivariateDistribution> &&
+                std::is_invocable_r_v<arma::Mat<float>, std::decay_t<Distribution> &, Generator &>>>
+  MultivariateDistribution(Distribution &&dist)
+      : self_(std::make_unique<Model<std::decay_t<Distribution>>>(
+            std::forward<Distribution>(dist))) {}
+
+  MultivariateDistribution(const MultivariateDistribution &other)
+      : self_(other.self_ ? other.self_->clone() : nullptr) {}
+
+  MultivariateDistribution(MultivariateDistribution &&) noexcept = default;
+
+  MultivariateDistribution &operator=(MultivariateDistribution other) noexcept {
+    self_ = std::move(other.self_);
+    return *this;
+  }
+
+  explicit operator bool() const { return static_cast<bool>(self_); }
+
+  /// Draws one column
+  arma::Mat<float> operator()(Generator &gen) { return self_->sample(gen); }
+
+  /// Fills every column of the matrix with one draw
+  void fill(Generator &gen, arma::Mat<float> &out) { self_->fill(gen, out); }
+};
 ///@}
 
 /// Univariate Distribution's Constructor
@@ -106,28 +339,36 @@ make_multivariate_distribution_impl(json const &j, Parameters... parameters) {
 
 /// @brief Fills the matrix with values drawn from the given distribution
 ///
+/// Each distribution fills its whole share of the matrix in one call, i.e., a
+/// row for the univariate distributions, or the entire matrix for the
+/// multivariate one.
+///
 /// @note At least one of the optionals should have values!
 static arma::Mat<float> fillMatrix(std::optional<std::vector<UnivariateDistribution>> &dists,
                             std::optional<MultivariateDistribution> &mdist,
                             int n_rows, int n_cols) {
   
-  arma::Mat<float> data(n_rows, n_cols);
+  auto &gen = sam::rng(sam::RandomStream::Data);
   
   if (mdist) {
     // Multivariate Distributions
     // Filling by columns because MultiDist returns a column of results
-    data.each_col([&](arma::Col<float> &v) { v = Random::get(mdist.value()); });
-  } else {
-    if (dists) {
-      // Set of Univariate Distributions
-      // Filling by rows because each row has its own distribution now
-      data.each_row([&, i = 0](arma::Row<float> &v) mutable {
-        v.imbue([&]() { return Random::get(dists.value()[i]); });
-        i++;
-      });
+    arma::Mat<float> data(n_rows, n_cols);
+    mdist.value().fill(gen, data);
+    return data;
+  }
+  
+  // Set of Univariate Distributions
+  // Each row has its own distribution; so, rows are being drawn as contiguous
+  // columns, and the matrix is transposed at the end
+  arma::Mat<float> data(n_cols, n_rows);
+  if (dists) {
+    for (int i{0}; i < n_rows; ++i) {
+      dists.value()[i].fill(gen, data.colptr(i), n_cols);
     }
   }
   
+  arma::inplace_trans(data);
   return data;
 }
 
@@ -31,6 +31,43 @@ namespace sam {
 
 class Submission;
 
+///
+/// @brief      Descriptive statistics of an Experiment's dependent variables
+///
+/// Each field is stored in its own contiguous row, indexed by the id of the
+/// dependent variables. Effect and Test Strategies are reading their inputs
+/// from here, rather than striding through the DependentVariable objects.
+///
+/// @note       The table is being kept up to date by the Experiment, see
+///             Experiment::calculateStatistics(). The results of the tests and
+///             effects are still being stored in the dependent variables.
+///
+/// @ingroup    Experiment
+///
+struct StatisticsTable {
+  arma::Row<float> nobs;
+  arma::Row<float> mean;
+  arma::Row<float> var;
+  arma::Row<float> stddev;
+  arma::Row<float> sei;
+
+  /// Resizes the table to n groups, while keeping the available values
+  void resize(arma::uword n) {
+    for (auto *row : {&nobs, &mean, &var, &stddev, &sei}) {
+      row->resize(n);
+    }
+  }
+
+  /// Copies the statistics of the given dependent variable into the table
+  void update(const DependentVariable &dv) {
+    nobs[dv.id_] = static_cast<float>(dv.nobs_);
+    mean[dv.id_] = dv.mean_;
+    var[dv.id_] = dv.var_;
+    stddev[dv.id_] = dv.stddev_;
+    sei[dv.id_] = dv.sei_;
+  }
+};
+
 ///
 /// @brief      Experiment encapsulates data and methods needed by the Researcher to
 /// conduct its research.
@@ -59,6 +96,35 @@ class Experiment {
   //! Indicates whether any of there are any covariant variable exists in the experiment
   bool is_covariants_generated{false};
 
+  /** @name Selective Re-computation
+   *  The effects and tests of a treatment group only depend on itself and its
+   *  control group; so, after a hacking strategy touches a few groups, only
+   *  their pairs need to be re-evaluated.
+   */
+  ///@{
+  enum PendingStage : unsigned char {
+    PendingEffects = 1,
+    PendingTests = 2,
+    PendingAll = PendingEffects | PendingTests
+  };
+
+  //! The stages that are out of date for each treatment group, indexed by id
+  std::vector<unsigned char> pending_;
+
+  //! The treatment groups that are being evaluated by the current stage
+  std::vector<int> stale_pairs_;
+
+  //! The descriptive statistics of all groups
+  StatisticsTable statistics_;
+
+  /// Updates the statistics of the dirty dependent variables, and marks their
+  /// pairs as pending
+  void sweepDirtyGroups();
+
+  /// Collects the pairs that are pending for the given stage, and clears them
+  void collectStalePairs(PendingStage stage);
+  ///@}
+
 public:
   int simid{0};
   int exprid{0};
@@ -76,6 +142,7 @@ public:
   std::shared_ptr<TestStrategy> test_strategy;
   std::shared_ptr<EffectStrategy> effect_strategy;
   
+  //! The dependent variables, always sorted by their ids
   std::vector<DependentVariable> dvs_;
 
   //! @brief  List of all possible candidates from this experiment so far!
@@ -150,10 +217,8 @@ public:
   /**
    * @name STL-like operators and methods
    *
-   * @attention begin() and end() operators do not return a sorted list of DVs. 
-   * This is due to Policies re-arranging them as they filter them. If you want 
-   * a sorted list of DVs, you should use the subscript operators, they make 
-   * sure that the correct item is returns every time! 
+   * The DVs are stored in the order of their ids, and Policies only re-arrange
+   * views of them as they filter them. So, `(*this)[i]` is the i-th group.
    * 
    */
   ///@{
@@ -177,20 +242,76 @@ public:
   /// Generates covariants data
   void generateCovariants();
 
-  /// Asks each DependentVariable to update its general statistics, e.g., mean, var.
+  /// Asks each dirty DependentVariable to update its general statistics, e.g., mean, var.
   void calculateStatistics();
   
-  /// Uses the TestStrategy to run the statistical test
+  /// Uses the TestStrategy to run the statistical test on the out of date pairs
   void calculateTests();
 
-  /// Uses the EffectStrategy to calculates the effect sizes.
+  /// Uses the EffectStrategy to calculates the effect sizes of the out of date pairs.
   void calculateEffects();
 
-  /// Runs calculateStatistics(), calculateTests(), and calculateEffects() in order.
+  /// Runs calculateStatistics(), calculateEffects(), and calculateTests() in order.
   void recalculateEverything();
+
+  /// Returns the treatment groups whose (control, treatment) pairs need to be
+  /// evaluated by the running Effect or Test Strategy
+  [[nodiscard]] const std::vector<int> &stalePairs() const {
+    return stale_pairs_;
+  }
+
+  /// Returns the descriptive statistics of all groups, indexed by their ids
+  [[nodiscard]] const StatisticsTable &statistics() const {
+    return statistics_;
+  }
+
+  /// Marks every pair as out of date
+  void invalidate() {
+    pending_.assign(setup.ng(), PendingAll);
+  }
   
   /// Clears the content of the experiment
   void clear();
+
+  /// @brief  A restorable state of the Experiment
+  ///
+  /// This only contains the parts of the Experiment that can be modified by
+  /// a HackingStrategy. Since the dependent variables are sharing their
+  /// measurements with the Experiment, taking a snapshot doesn't copy any raw
+  /// data, and the Experiment only pays for the rows that are being modified
+  /// after the snapshot is taken.
+  struct Snapshot {
+    std::vector<DependentVariable> dvs;
+    std::vector<unsigned char> pending;
+    int nc{0};
+    bool is_hacked{false};
+    bool has_candidates{false};
+    bool is_covariants_generated{false};
+  };
+
+  /// Takes a snapshot of the current state of the Experiment
+  [[nodiscard]] Snapshot snapshot() const;
+
+  /// Restores the Experiment to the given snapshot
+  void restore(const Snapshot &snap);
+
+  /// @brief  Restores the Experiment to a snapshot when leaving the scope
+  ///
+  /// The Experiment is being restored on every exit, including the ones caused
+  /// by an exception thrown from a HackingStrategy, or a Policy.
+  class ScopedRestore {
+    Experiment &experiment_;
+    const Snapshot &snapshot_;
+
+  public:
+    ScopedRestore(Experiment &experiment, const Snapshot &snapshot)
+        : experiment_{experiment}, snapshot_{snapshot} {}
+
+    ScopedRestore(const ScopedRestore &) = delete;
+    ScopedRestore &operator=(const ScopedRestore &) = delete;
+
+    ~ScopedRestore() { experiment_.restore(snapshot_); }
+  };
   
   /// Set or re-set the Test Strategy
   ///
@@ -198,6 +319,7 @@ public:
   ///
   void setTestStrategy(std::shared_ptr<TestStrategy> &ts) {
     test_strategy = ts;
+    invalidate();
   }
   
   /// Set or re-set the Data Strategy
@@ -214,6 +336,7 @@ public:
   ///
   void setEffectSizeEstimator(std::shared_ptr<EffectStrategy> &es) {
     effect_strategy = es;
+    invalidate();
   };
 
 private:
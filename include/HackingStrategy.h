@@ -26,6 +26,7 @@
 #include <optional>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "Distributions.h"
 #include "Experiment.h"
@@ -170,6 +171,35 @@ public:
   /// @brief      Adds new observations to each group
   void addObservations(Experiment *experiment, const arma::Row<int> &ns);
 
+  /// @brief      Future observations of the current experiment
+  ///
+  /// Row `g - reservoir_begin` holds every observation that has been drawn for
+  /// the target group `g` during the current hacking, and `reservoir_ends` points
+  /// to the first one that has not been added yet. So, the rest of the row is
+  /// what the researcher would have collected had they not stopped.
+  ///
+  /// The reservoir is only being grown when an attempt runs out of
+  /// observations, see growReservoir().
+  std::vector<std::vector<float>> reservoir;
+  std::vector<std::size_t> reservoir_ends;
+  int reservoir_begin{0};
+
+private:
+  //! Number of attempts that the next batch of the reservoir will cover
+  int n_batch_attempts{1};
+
+  //! Number of attempts that have not been performed yet
+  int n_remaining_attempts{0};
+
+  //! The last batch of observations, one column per target group
+  arma::Mat<float> batch;
+
+  /// @brief      Empties the reservoir before a new hacking
+  void clearReservoir(Experiment *experiment, int n_attempts);
+
+  /// @brief      Draws the next batch of observations into the reservoir
+  void growReservoir(Experiment *experiment, const arma::Row<int> &ns);
+
 };
 
 inline void to_json(json &j, const OptionalStopping::Parameters &p) {
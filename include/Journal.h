@@ -15,6 +15,7 @@
 #ifndef SAMPP_JOURNAL_H
 #define SAMPP_JOURNAL_H
 
+#include <utility>
 #include <variant>
 
 #include "MetaAnalysis.h"
@@ -26,18 +27,24 @@ namespace sam {
 
 class MetaAnalysis;
 
-//! A std::variant containing all different meta-analysis result type
-using MetaAnalysisOutcome = std::variant<
-FixedEffectEstimator::ResultType, RandomEffectEstimator::ResultType,
-EggersTestEstimator::ResultType, TestOfObsOverExptSig::ResultType,
-TrimAndFill::ResultType, RankCorrelation::ResultType>;
-
-//! @brief      A list of meta-analysis results.
+//! @brief      A typed buffer of the results of one meta-analysis method
+//!
+//! Results are stored contiguously by their own type; so, only one dispatch is
+//! needed per buffer, rather than per result.
+//!
+using MetaAnalysisBuffer = std::variant<
+std::vector<FixedEffectEstimator::ResultType>,
+std::vector<RandomEffectEstimator::ResultType>,
+std::vector<EggersTestEstimator::ResultType>,
+std::vector<TestOfObsOverExptSig::ResultType>,
+std::vector<TrimAndFill::ResultType>,
+std::vector<RankCorrelation::ResultType>>;
+
+//! @brief      A list of meta-analysis results, indexed by the methods' slots
 //!
-//! The `std::variant` allows me to don't worry about the method of choice, and 
-//! iterate over any arbitrary methods using a `std::visit`.
+//! @see        MetaAnalysis::slot
 //!
-using MetaAnalysisResults = std::vector<MetaAnalysisOutcome>;
+using MetaAnalysisResults = std::vector<MetaAnalysisBuffer>;
 
 ///
 /// @brief      Journal Class
@@ -103,29 +110,25 @@ class Journal {
   //! Indicates whether the Journal is saving the aggregated meta-analyses
   bool is_saving_meta{false};
   
-  //! A vector of variants containing the outcome of each meta-analysis
+  //! Results of each meta-analysis, indexed by the methods' slots
   MetaAnalysisResults meta_analysis_submissions;
   
   //! A group of csv headers for each meta-analysis method
-  std::map<std::string, std::vector<std::string>> meta_columns;
+  std::vector<std::vector<std::string>> meta_columns;
   
   //! A group of CSV writers each dealing with IO of one selected meta-analysis
   //! method
-  std::map<std::string, PersistenceManager::Writer> meta_writers;
+  std::vector<std::unique_ptr<PersistenceManager::Writer>> meta_writers;
   
   //! AGGREGATE RUNNER ↓
   
   //! A group of stat runners aggregating information of every meta-analysis
   //! method chosen
-  std::map<std::string, arma::running_stat_vec<arma::Row<float>>>
-  meta_stats_runners;
-  
-  //! A group of csv headers for each meta-analysis aggregated method
-  std::map<std::string, std::vector<std::string>> meta_stats_columns;
+  std::vector<arma::running_stat_vec<arma::Row<float>>> meta_stats_runners;
   
   //! A group of CSv writers each writing the *aggregated* statistics of one
   //! meta-analysis method over the entire simulation
-  std::map<std::string, PersistenceManager::Writer> meta_stats_writers;
+  std::vector<std::unique_ptr<PersistenceManager::Writer>> meta_stats_writers;
   ///@}
 
   /** @name Submissions Per Simulation Running Statistics Engines.
@@ -144,6 +147,21 @@ class Journal {
   std::unique_ptr<PersistenceManager::Writer> pubs_per_sim_stats_writer;
   ///@}
 
+  /** @name Meta-analysis Pools
+   */
+  ///@{
+  //! Effect sizes, variances, sample sizes, and significances of the studies
+  //! included in #meta_sums. They are being filled by accept(), and their
+  //! capacities are being reused between simulations.
+  std::vector<float> yi_pool;
+  std::vector<float> vi_pool;
+  std::vector<float> ni_pool;
+  std::vector<float> sig_pool;
+  ///@}
+
+  /// Adds the submissions to the meta-analysis sums and pools
+  void accumulate(const std::vector<Submission> &subs);
+
  public:
 
   //! List of all accepted submissions, i.e., outcomes
@@ -162,6 +180,15 @@ class Journal {
   //! The weight of the accepted submissions, computed as 1./vi;
   arma::Row<float> wi;
 
+  //! The sample size of the accepted submissions
+  arma::Row<float> ni;
+
+  //! The significance of the accepted submissions
+  arma::Row<float> sigs;
+
+  //! Running sums of the accepted submissions
+  MetaAnalysisSums meta_sums;
+
   //! Journal's Selection Model/Strategy
   std::unique_ptr<ReviewStrategy> review_strategy;
   
@@ -204,15 +231,39 @@ class Journal {
   /// Saves MetaAnalysis Results
   void saveMetaAnalysis();
 
+  /// Writes the given MetaAnalysis Results, slot by slot, using the given
+  /// writers. It doesn't read any Journal; so, it can be called by the
+  /// persistence thread while the Journal is being used.
+  static void writeMetaAnalysis(
+      const std::vector<PersistenceManager::Writer *> &writers,
+      MetaAnalysisResults &results);
+
+  /// Returns the writers of the meta-analysis slots
+  [[nodiscard]] std::vector<PersistenceManager::Writer *>
+  metaAnalysisWriters() const;
+
+  /// Returns the writer of the Per Simulation summaries of Publications
+  [[nodiscard]] PersistenceManager::Writer *
+  publicationsPerSimSummariesWriter() const {
+    return pubs_per_sim_stats_writer.get();
+  }
+
   /// Saves Overall Summaries
   void saveSummaries();
 
-  /// Stores the MetaAnalysisOutcome
-  void storeMetaAnalysisResult(const MetaAnalysisOutcome &res);
+  /// Stores the result of the meta-analysis method registered at the given slot
+  template <typename ResultType>
+  void storeMetaAnalysisResult(std::size_t slot, const ResultType &res) {
+    std::get<std::vector<ResultType>>(meta_analysis_submissions[slot])
+        .push_back(res);
+  }
 
   /// Saves the Per Simulation summary of Publications
   void savePublicationsPerSimSummaries();
 
+  /// Prepares the Per Simulation summary of Publications, and resets its runner
+  std::map<std::string, std::string> publicationsPerSimSummaries();
+
   /// Clear the Journal
   void clear();
 
@@ -225,8 +276,15 @@ class Journal {
   /// Runs the meta-analysis methods
   void runMetaAnalysis();
   
-  /// Updates the overall stats runners
-  void updateMetaStatsRunners();
+  /// Updates the overall stats runners of the given slot
+  void updateMetaStatsRunners(std::size_t slot);
+
+  /// Collects the outcome of a simulation performed by another Journal
+  void collect(std::vector<Submission> &&pubs, std::vector<Submission> &&rejs,
+               MetaAnalysisResults &&metas);
+
+  /// Releases the list of collected meta-analysis results
+  MetaAnalysisResults releaseMetaAnalysisResults();
   
   //! Returns Journal's CSV header
   static std::vector<std::string> Columns();
@@ -0,0 +1,154 @@
+//===-- MeasurementArena.h - Pooled Storage of Measurements ---------------===//
+//
+// Part of the SAM Project
+// Created by Amir Masoud Abdol on 2020-11-16.
+//
+//===----------------------------------------------------------------------===//
+///
+/// @file
+/// This file contains the declaration of MeasurementArena, a per-thread pool of
+/// memory blocks backing the measurements of dependent variables, and
+/// MeasurementBuffer, a reference counted handle to one of those blocks.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef SAMPP_MEASUREMENTARENA_H
+#define SAMPP_MEASUREMENTARENA_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace sam {
+
+///
+/// @brief      A block of measurements
+///
+/// The values are stored right after the header, and the capacity of a block
+/// is always a power of two, i.e., `2^size_class`.
+///
+struct MeasurementBlock {
+  std::atomic<int> refs{1};
+  int size_class{0};
+  std::size_t size{0};
+
+  float *data() { return reinterpret_cast<float *>(this + 1); }
+
+  [[nodiscard]] std::size_t capacity() const {
+    return std::size_t{1} << size_class;
+  }
+};
+
+///
+/// @brief      A pool of measurement blocks
+///
+/// Every block that is not being used anymore is kept in the free list of its
+/// size class, and it will be handed out again to the next buffer of that
+/// class. So, after the first few experiments, creating, growing, and
+/// releasing the measurements of dependent variables don't touch the
+/// allocator anymore.
+///
+/// Blocks are plain heap allocations, and they can be returned to any arena,
+/// e.g., when a Submission is being destroyed on another thread.
+///
+/// Each thread has its own arena, accessible via local().
+///
+class MeasurementArena {
+public:
+  /// The smallest size class, i.e., 16 values
+  static constexpr int min_size_class{4};
+  static constexpr int max_size_class{40};
+  /// Maximum number of free blocks that are kept in each size class
+  static constexpr std::size_t max_cached_blocks{1024};
+
+  MeasurementArena() = default;
+  MeasurementArena(const MeasurementArena &) = delete;
+  MeasurementArena &operator=(const MeasurementArena &) = delete;
+
+  ~MeasurementArena() { release(); }
+
+  /// Returns an empty block that can hold at least n values
+  MeasurementBlock *allocate(std::size_t n);
+
+  /// Returns the block to the pool
+  void deallocate(MeasurementBlock *block);
+
+  /// Makes sure that at least `count` blocks of n values are available
+  void reserve(std::size_t n, std::size_t count);
+
+  /// Frees all the cached blocks
+  void release();
+
+  /// Returns the number of cached blocks
+  [[nodiscard]] std::size_t nCachedBlocks() const;
+
+  /// Returns the size class of a block with n values
+  static int sizeClassOf(std::size_t n);
+
+  /// Returns the MeasurementArena of the calling thread
+  static MeasurementArena &local();
+
+private:
+  std::array<std::vector<MeasurementBlock *>, max_size_class + 1> free_;
+};
+
+///
+/// @brief      A reference counted handle to a MeasurementBlock
+///
+/// Copies of a buffer are sharing the same block, and the block will be
+/// returned to the arena of the calling thread when the last copy is gone.
+///
+class MeasurementBuffer {
+  MeasurementBlock *block_{nullptr};
+
+public:
+  MeasurementBuffer() = default;
+
+  /// Acquires an empty block for at least `capacity` values
+  explicit MeasurementBuffer(std::size_t capacity)
+      : block_{MeasurementArena::local().allocate(capacity)} {}
+
+  MeasurementBuffer(const MeasurementBuffer &other) noexcept
+      : block_{other.block_} {
+    if (block_) {
+      block_->refs.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+
+  MeasurementBuffer(MeasurementBuffer &&other) noexcept
+      : block_{std::exchange(other.block_, nullptr)} {}
+
+  MeasurementBuffer &operator=(MeasurementBuffer other) noexcept {
+    std::swap(block_, other.block_);
+    return *this;
+  }
+
+  ~MeasurementBuffer() { reset(); }
+
+  /// Drops the reference to the block
+  void reset();
+
+  explicit operator bool() const { return block_ != nullptr; }
+
+  [[nodiscard]] float *data() const {
+    return block_ ? block_->data() : nullptr;
+  }
+
+  [[nodiscard]] std::size_t size() const { return block_ ? block_->size : 0; }
+
+  void setSize(std::size_t n) { block_->size = n; }
+
+  [[nodiscard]] std::size_t capacity() const {
+    return block_ ? block_->capacity() : 0;
+  }
+
+  [[nodiscard]] int use_count() const {
+    return block_ ? block_->refs.load(std::memory_order_relaxed) : 0;
+  }
+};
+
+} // namespace sam
+
+#endif // SAMPP_MEASUREMENTARENA_H
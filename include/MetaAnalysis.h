@@ -18,7 +18,10 @@
 #ifndef SAMPP_METAANALYSIS_H
 #define SAMPP_METAANALYSIS_H
 
+#include <algorithm>
+#include <cmath>
 #include <ostream>
+#include <tuple>
 #include <vector>
 
 #include "sam.h"
@@ -33,10 +36,71 @@ using namespace std;
 
 class Journal;
 
+///
+/// @brief Running sums of the studies accepted by a Journal
+///
+/// The sums are being updated as studies are being accepted, and they are
+/// sufficient for finalizing the fixed-effect estimate, Cochran's Q, and DL's
+/// tau2 in O(1), without another pass over the publications.
+///
+/// @note       Studies without a finite weight, i.e., with zero variance, are
+///             not included in the sums, and are only counted.
+///
+struct MetaAnalysisSums {
+  //! Number of included studies
+  int k{0};
+  
+  //! Number of significant studies
+  int n_sig{0};
+  
+  //! Number of excluded studies
+  int n_excluded{0};
+  
+  //! Σ wi, Σ wi yi, Σ wi yi^2, and Σ wi^2 with wi = 1 / vi
+  double sw{0};
+  double swy{0};
+  double swy2{0};
+  double sw2{0};
+  
+  /// Adds a study to the sums, returns false if the study is excluded
+  bool add(float yi, float vi, bool sig) {
+    const double wi = 1. / vi;
+    if (!std::isfinite(wi)) {
+      ++n_excluded;
+      return false;
+    }
+    
+    ++k;
+    n_sig += sig;
+    sw += wi;
+    swy += wi * yi;
+    swy2 += wi * yi * yi;
+    sw2 += wi * wi;
+    return true;
+  }
+  
+  void clear() { *this = MetaAnalysisSums{}; }
+  
+  /// Returns the fixed-effect estimate
+  [[nodiscard]] double est() const { return swy / sw; }
+  
+  /// Returns Cochran's Q, Σ wi (yi - est)^2
+  [[nodiscard]] double q() const { return std::max(0., swy2 - swy * swy / sw); }
+  
+  /// Returns the DerSimonian-Laird estimate of tau2
+  [[nodiscard]] double tau2DL() const {
+    return std::max(0., (q() - (k - 1)) / (sw - sw2 / sw));
+  }
+};
+
 class MetaAnalysis {
 
 public:
 
+  //! Index of the method in its Journal's list of methods, and results. This
+  //! is assigned by the Journal when the method is being registered.
+  std::size_t slot{0};
+
   virtual ~MetaAnalysis() = 0;
 
   static std::unique_ptr<MetaAnalysis> build(std::string name);
@@ -82,6 +146,15 @@ public:
     static std::vector<std::string> Columns() {
       return {"est", "se", "ci_lb", "ci_ub", "zval", "pval", "q_stat", "q_pval", "tau2"};
     }
+
+    /// Members of the result, in the order of Columns()
+    static constexpr auto Fields() {
+      return std::make_tuple(&ResultType::est, &ResultType::se,
+                             &ResultType::ci_lb, &ResultType::ci_ub,
+                             &ResultType::zval, &ResultType::pval,
+                             &ResultType::q_stat, &ResultType::q_pval,
+                             &ResultType::tau2);
+    }
     
     operator std::vector<std::string>() {
       return {
@@ -133,7 +206,8 @@ public:
   struct Parameters {
     std::string name{"RandomEffectEstimator"};
     
-    //! The random effect estimator
+    //! The random effect estimator, i.e., DL, PM, REML, ML, or EB. The name
+    //! must match exactly, see tau2_estimators.
     std::string estimator{"DL"};
     
     NLOHMANN_DEFINE_TYPE_INTRUSIVE(RandomEffectEstimator::Parameters, name, estimator);
@@ -143,13 +217,34 @@ public:
   
   RandomEffectEstimator() = default;
   
-  RandomEffectEstimator(const Parameters &p) : params{p} {};
+  /// Constructs the estimator, and exits if the tau2 estimator is unknown
+  RandomEffectEstimator(const Parameters &p);
+
+  /// List of available tau2 estimators
+  static inline const std::vector<std::string> tau2_estimators{
+      "DL", "PM", "REML", "ML", "EB"};
   
   void estimate(Journal *journal);
   
   static ResultType RandomEffect(const arma::Row<float> &vi, const arma::Row<float> &yi, float tau2);
-  float DL(const arma::Row<float> &yi, const arma::Row<float> &vi, const arma::Row<float> &wi);
-  float PM(const arma::Row<float> &yi, const arma::Row<float> &vi, const float tau2);
+  
+  /// Maximum number of iterations of the iterative tau2 estimators
+  static constexpr int max_iterations{100};
+  
+  /// Convergence threshold of the iterative tau2 estimators
+  static constexpr double tolerance{1e-8};
+  
+  static float DL(const arma::Row<float> &yi, const arma::Row<float> &vi, const arma::Row<float> &wi);
+  static float PM(const arma::Row<float> &yi, const arma::Row<float> &vi, float tau2_init);
+  static float REML(const arma::Row<float> &yi, const arma::Row<float> &vi, float tau2_init);
+  static float ML(const arma::Row<float> &yi, const arma::Row<float> &vi, float tau2_init);
+  static float EB(const arma::Row<float> &yi, const arma::Row<float> &vi, float tau2_init);
+  
+  /// Estimates tau2 using the given estimator, warm-started from DL
+  static float Tau2(const arma::Row<float> &yi, const arma::Row<float> &vi, const std::string &estimator);
+  
+  /// Estimates tau2 of every journal using the given estimator
+  static std::vector<float> Tau2(const std::vector<const Journal *> &journals, const std::string &estimator);
 };
 
 
@@ -191,6 +286,15 @@ public:
     static std::vector<std::string> Columns() {
       return {"est", "se", "ci_lb", "ci_ub", "zval", "pval", "q_stat", "q_pval", "tau2"};
     }
+
+    /// Members of the result, in the order of Columns()
+    static constexpr auto Fields() {
+      return std::make_tuple(&ResultType::est, &ResultType::se,
+                             &ResultType::ci_lb, &ResultType::ci_ub,
+                             &ResultType::zval, &ResultType::pval,
+                             &ResultType::q_stat, &ResultType::q_pval,
+                             &ResultType::tau2);
+    }
     
     operator std::vector<std::string>() {
       return {
@@ -237,6 +341,8 @@ public:
   static ResultType FixedEffect(const arma::Row<float> &yi, const arma::Row<float> &vi) {
     return RandomEffectEstimator::RandomEffect(yi, vi, 0);
   }
+  
+  static ResultType FixedEffect(const MetaAnalysisSums &sums);
 };
 
 ///
@@ -274,6 +380,13 @@ public:
     static std::vector<std::string> Columns() {
       return {"slope", "se", "tstat", "pval", "sig", "df"};
     }
+
+    /// Members of the result, in the order of Columns()
+    static constexpr auto Fields() {
+      return std::make_tuple(&ResultType::slope, &ResultType::se,
+                             &ResultType::tstat, &ResultType::pval,
+                             &ResultType::sig, &ResultType::df);
+    }
     
     operator std::vector<std::string>() {
       return {
@@ -350,6 +463,12 @@ public:
     static std::vector<std::string> Columns() {
       return {"E", "A", "pval", "sig"};
     }
+
+    /// Members of the result, in the order of Columns()
+    static constexpr auto Fields() {
+      return std::make_tuple(&ResultType::E, &ResultType::A,
+                             &ResultType::pval, &ResultType::sig);
+    }
     
     operator std::vector<std::string>() {
       return {
@@ -412,6 +531,14 @@ public:
     static std::vector<std::string> Columns() {
       return {"k0", "se_k0", "k_all", "side", "imputed_est", "imputed_pval"};
     }
+
+    /// Members of the result, in the order of Columns()
+    static constexpr auto Fields() {
+      return std::make_tuple(&ResultType::k0, &ResultType::se_k0,
+                             &ResultType::k_all, &ResultType::side,
+                             &ResultType::imputed_est,
+                             &ResultType::imputed_pval);
+    }
     
     operator std::vector<std::string>() {
       return {
@@ -452,6 +579,27 @@ public:
     NLOHMANN_DEFINE_TYPE_INTRUSIVE(TrimAndFill::Parameters, name, side, estimator, alpha);
   };
   
+  /// @brief Scratch buffers of TF
+  ///
+  /// The buffers only grow, and are being reused between calls; so, after the
+  /// largest journal has been seen, TF does not allocate anymore.
+  struct Workspace {
+    //! Sorting indices of the studies
+    std::vector<arma::uword> ix;
+    
+    //! Sorted, and possibly flipped, effect sizes
+    std::vector<float> yi_s;
+    
+    //! Prefix sums of the sorted weights, and weighted effect sizes
+    std::vector<double> cum_wi;
+    std::vector<double> cum_wyi;
+    
+    void resize(std::size_t k);
+    
+    /// Returns the Workspace of the calling thread
+    static Workspace &local();
+  };
+  
   Parameters params;
   
   TrimAndFill() = default;
@@ -460,7 +608,11 @@ public:
   
   void estimate(Journal *journal);
   
-  static ResultType TF(arma::Row<float> yi, arma::Row<float> vi, arma::Row<float> ni, const Parameters &params);
+  static ResultType TF(const arma::Row<float> &yi, const arma::Row<float> &vi, const Parameters &params);
+  
+  static ResultType TF(const arma::Row<float> &yi, const arma::Row<float> &vi, const Parameters &params, Workspace &ws);
+  
+  static std::vector<ResultType> TF(const std::vector<const Journal *> &journals, const Parameters &params);
   
 };
 
@@ -484,6 +636,12 @@ public:
     static std::vector<std::string> Columns() {
       return {"est", "pval", "sig"};
     }
+
+    /// Members of the result, in the order of Columns()
+    static constexpr auto Fields() {
+      return std::make_tuple(&ResultType::est, &ResultType::pval,
+                             &ResultType::sig);
+    }
     
     operator std::vector<std::string>() {
       return {
@@ -534,11 +692,11 @@ public:
 
 float kendallcor(const arma::Row<float> &x, const arma::Row<float> &y);
 
-std::pair<float, float> kendall_cor_test(const arma::Row<float> &x, const arma::Row<float> &y, const TestStrategy::TestAlternative alternative);
+std::pair<float, float> kendall_cor_test(const arma::Row<float> &x, const arma::Row<float> &y, const TestStrategy::TestAlternative alternative, int exact_threshold = 50);
 
-float ckendall(int k, int n, float **w);
+const std::vector<double> &kendall_null_distribution(int n);
 
-void pkendall(int len, float *Q, float *P, int n);
+float pkendall(int q, int n);
 
 } // namespace sam
 
@@ -0,0 +1,85 @@
+//===-- PValueService.h - Cached Student's t Probabilities ----------------===//
+//
+// Part of the SAM Project
+// Created by Amir Masoud Abdol on 2020-11-09.
+//
+//===----------------------------------------------------------------------===//
+///
+/// @file
+/// This file contains the declaration of PValueService, a per-thread cache of
+/// Student's t tail probabilities keyed by the degrees of freedom.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef SAMPP_PVALUESERVICE_H
+#define SAMPP_PVALUESERVICE_H
+
+#include <cmath>
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+
+namespace sam {
+
+///
+/// @brief      A cache of Student's t probabilities keyed by degrees of freedom
+///
+/// Within a simulation, the sample sizes, and therefore the degrees of freedom,
+/// of the tests barely change. PValueService takes advantage of this by
+/// tabulating the upper tail probabilities of every integer df, and their
+/// derivatives, on a regular grid of `[0, table_max]`, the first time that the
+/// df is being used. Probabilities are then computed using a cubic Hermite
+/// interpolation, with an error of order 1e-10. Statistics outside of the
+/// table, and non-integer dfs, e.g., Welch's or Yuen's, are being evaluated
+/// exactly.
+///
+/// A df's table only depends on the df; so, a probability doesn't depend on
+/// which thread computes it, or on what that thread has computed before.
+///
+/// Each thread has its own service, accessible via local().
+///
+class PValueService {
+
+  struct Entry {
+    std::vector<double> tail;
+    std::vector<double> dtail;
+  };
+
+  std::unordered_map<float, Entry> entries_;
+
+  const Entry &entry(float df);
+
+  static void buildTable(Entry &e, float df);
+
+public:
+  /// The upper bound of the table
+  static constexpr double table_max{16.};
+  /// Number of table nodes per unit
+  static constexpr int table_resolution{64};
+  /// Maximum number of cached dfs
+  static constexpr std::size_t max_entries{512};
+
+  /// Indicates whether the probabilities of df are being tabulated
+  static bool isTabulated(float df) {
+    return std::isfinite(df) && df > 0 && df == std::floor(df);
+  }
+
+  /// Returns P(T > t)
+  double upperTail(double t, float df);
+
+  /// Returns P(T <= t)
+  double cdf(double t, float df) { return upperTail(-t, df); }
+
+  /// Returns the number of cached dfs
+  [[nodiscard]] std::size_t size() const { return entries_.size(); }
+
+  /// Removes all cached values
+  void clear() { entries_.clear(); }
+
+  /// Returns the PValueService of the calling thread
+  static PValueService &local();
+};
+
+} // namespace sam
+
+#endif // SAMPP_PVALUESERVICE_H
@@ -5,6 +5,16 @@
 #ifndef SAMPP_PERSISTENCEMANAGER_H
 #define SAMPP_PERSISTENCEMANAGER_H
 
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
 #include <csv/reader.hpp>
 #include <csv/writer.hpp>
 
@@ -23,10 +33,144 @@ class PersistenceManager {
 public:
   class Writer;
   class Reader;
+  class ColumnarWriter;
+  class AsyncWriter;
+
+  ///
+  /// Specifies the format of the Publications, Rejected, and Experiments files
+  ///
+  enum class OutputFormat {
+    CSV,   ///< Comma separated values
+    Binary ///< See PersistenceManager::ColumnarWriter
+  };
 
   ~PersistenceManager() = default;
 };
 
+NLOHMANN_JSON_SERIALIZE_ENUM(PersistenceManager::OutputFormat,
+                             {{PersistenceManager::OutputFormat::CSV, "csv"},
+                              {PersistenceManager::OutputFormat::Binary,
+                               "binary"}})
+
+///
+/// @brief      A writer for SAM's binary columnar format
+///
+/// The file starts with a header describing its schema, followed by a series
+/// of chunks. Each chunk stores up to `chunk_size` rows, column by column. All
+/// values are stored in little-endian order, i.e., they are byte-swapped on
+/// big-endian hosts, and the layout is as follows:
+///
+/// ```
+/// header := "SAMCOL01"                  8 bytes magic
+///           uint32 n_columns
+///           n_columns * column
+/// column := uint8  type                 0: int32, 1: float32, 2: bool (uint8)
+///           uint16 name_length
+///           name_length * char
+/// chunk  := uint32 n_rows
+///           n_columns * (n_rows * value)
+/// ```
+///
+/// A file is read by reading its header, and then reading chunks until the
+/// end of the file, e.g., using `numpy.frombuffer` on each column.
+///
+class PersistenceManager::ColumnarWriter {
+
+public:
+  enum class ColumnType : std::uint8_t { Int32 = 0, Float32 = 1, Bool = 2 };
+
+private:
+  struct Column {
+    std::string name;
+    ColumnType type;
+    std::vector<char> buffer;
+  };
+
+  std::ofstream out_;
+  std::vector<Column> columns_;
+  std::uint32_t n_rows_{0};
+  std::uint32_t chunk_size_;
+
+  /// Returns the little-endian representation of the value
+  template <typename T> static T toLittleEndian(T value) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    auto *p = reinterpret_cast<char *>(&value);
+    std::reverse(p, p + sizeof(T));
+#endif
+    return value;
+  }
+
+  template <typename T> void put(T value) {
+    value = toLittleEndian(value);
+    out_.write(reinterpret_cast<const char *>(&value), sizeof(T));
+  }
+
+  template <typename T> static void append(std::vector<char> &buffer, T value) {
+    value = toLittleEndian(value);
+    const auto *p = reinterpret_cast<const char *>(&value);
+    buffer.insert(buffer.end(), p, p + sizeof(T));
+  }
+
+  /// Returns the column type that stores values of the given type
+  static constexpr ColumnType typeOf(int) { return ColumnType::Int32; }
+  static constexpr ColumnType typeOf(float) { return ColumnType::Float32; }
+  static constexpr ColumnType typeOf(bool) { return ColumnType::Bool; }
+
+  /// Makes sure that the value matches the type of its column
+  static void expect(const Column &col, ColumnType type) {
+    if (col.type != type) {
+      throw std::invalid_argument("The value of column `" + col.name +
+                                  "` doesn't match its type.");
+    }
+  }
+
+  static void push(Column &col, int value) {
+    append(col.buffer, static_cast<std::int32_t>(value));
+  }
+  static void push(Column &col, float value) { append(col.buffer, value); }
+  static void push(Column &col, bool value) {
+    append(col.buffer, static_cast<std::uint8_t>(value));
+  }
+
+public:
+  ColumnarWriter(const std::string &filename,
+                 std::uint32_t chunk_size = 1u << 16);
+  ~ColumnarWriter();
+
+  [[nodiscard]] bool hasSchema() const { return !columns_.empty(); }
+
+  /// Writes the header of the file, this must be called before writing rows
+  ///
+  /// @throws std::invalid_argument if names and types have different sizes
+  void setSchema(const std::vector<std::string> &names,
+                 const std::vector<ColumnType> &types);
+
+  /// Appends a row, values must follow the order, and types, of the schema
+  ///
+  /// The whole row is being checked before any of its values is appended; so,
+  /// a rejected row leaves the columns aligned.
+  ///
+  /// @throws std::invalid_argument if the row doesn't match the schema
+  template <typename... Ts> void writeRow(const Ts &...values) {
+    if (sizeof...(Ts) != columns_.size()) {
+      throw std::invalid_argument("The row doesn't match the schema.");
+    }
+
+    std::size_t i{0};
+    (expect(columns_[i++], typeOf(values)), ...);
+
+    i = 0;
+    (push(columns_[i++], values), ...);
+
+    if (++n_rows_ == chunk_size_) {
+      flush();
+    }
+  }
+
+  /// Writes the buffered rows as a new chunk
+  void flush();
+};
+
 /// Declaration of the Writer class
 class PersistenceManager::Writer {
 
@@ -41,6 +185,10 @@ class PersistenceManager::Writer {
   //! A unique pointer to a new writer object,
   //! @todo: Check if there is a better way of implementing this
   std::unique_ptr<csv::Writer> writer;
+
+  //! The binary writer, only used by Submission and DependentVariable writes
+  //! when the output format is OutputFormat::Binary
+  std::unique_ptr<ColumnarWriter> columnar;
   
   std::vector<std::string> column_names;
 
@@ -51,6 +199,8 @@ public:
   ~Writer();
 
   Writer(const std::string &filename);
+
+  Writer(const std::string &filename, OutputFormat format);
   
   Writer(const std::string &path, const string &prefix, const std::string filename);
   
@@ -60,6 +210,10 @@ public:
   
   void write(const std::map<string, string> &row);
 
+  /// Writes a block of formatted rows, each terminated by a line break, in
+  /// one call. The header is written first, if it hasn't been written yet.
+  void writeBlock(std::string_view rows);
+
   void write(const Submission &sub);
 
   /// Write a list of submission records to a file, or a database
@@ -70,6 +224,14 @@ public:
   /// @param expr A reference to Experience
   void write(Experiment *expr, int sid = 0);
 
+  /// Write a list of dependent variables into a file, or a database
+  /// @param dvs A reference to the list of dependent variables
+  /// @param sid The simulation id
+  /// @param exprid The experiment id, i.e., the Submission::exprid of the
+  /// submissions made from these dependent variables
+  void write(const std::vector<DependentVariable> &dvs, int sid = 0,
+             int exprid = 0);
+
   /// Write each groups' data to a file, or a database
   /// @param data A reference to the Experiment->measurements
   void write(std::vector<arma::Row<float>> &data, int sid = 0);
@@ -82,6 +244,53 @@ public:
   
 };
 
+///
+/// @brief      A dedicated persistence thread
+///
+/// The simulation loop pushes its write jobs, e.g., writing a batch of
+/// publications, into a bounded queue, and the persistence thread formats and
+/// flushes them in the order that they have been pushed. The simulation only
+/// waits when the queue is full, i.e., when the disk cannot keep up.
+///
+/// @note       A job must own, or outlive, whatever it writes; the simulation
+///             is free to reuse its buffers as soon as push() returns.
+///
+/// If the capacity is zero, jobs are being performed immediately by the
+/// calling thread.
+///
+class PersistenceManager::AsyncWriter {
+
+  std::deque<std::function<void()>> jobs_;
+  std::size_t capacity_;
+
+  std::mutex mutex_;
+  std::condition_variable has_jobs_;
+  std::condition_variable has_space_;
+  std::condition_variable is_idle_;
+
+  bool is_busy_{false};
+  bool is_stopping_{false};
+
+  std::thread worker_;
+
+  void loop();
+
+public:
+  explicit AsyncWriter(std::size_t capacity);
+
+  /// Drains the queue, and stops the persistence thread
+  ~AsyncWriter();
+
+  AsyncWriter(const AsyncWriter &) = delete;
+  AsyncWriter &operator=(const AsyncWriter &) = delete;
+
+  /// Queues a new job, and waits if the queue is full
+  void push(std::function<void()> job);
+
+  /// Waits until all the queued jobs are done
+  void drain();
+};
+
 class PersistenceManager::Reader {
 
   string file_name_;
@@ -47,6 +47,110 @@ enum class PolicyType : int { Min, Max, Comp, Random, First, Last, All };
 /// @ingroup    Policies
 enum class PolicyChainType : int { Selection, Decision };
 
+/// @brief      List of variables that are accessible to native policies
+///
+/// @ingroup    Policies
+enum class PolicyVariable : int {
+  Id,
+  Nobs,
+  Mean,
+  Pvalue,
+  Effect,
+  Sig,
+  Hacked,
+  Candidate
+};
+
+/// @brief      List of comparison operators supported by native policies
+///
+/// @ingroup    Policies
+enum class PolicyOperator : int {
+  GreaterEq,
+  LesserEq,
+  Greater,
+  Lesser,
+  Equal,
+  NotEqual
+};
+
+/// @brief      Returns the value of the given variable of a dependent variable
+///
+/// Everything is promoted to `double` to match the semantic of the Lua
+/// policies, where all numbers are `double`.
+///
+/// @ingroup    Policies
+inline double valueOf(const DependentVariable &dv, PolicyVariable var) {
+  switch (var) {
+  case PolicyVariable::Id:
+    return dv.id_;
+  case PolicyVariable::Nobs:
+    return dv.nobs_;
+  case PolicyVariable::Mean:
+    return dv.mean_;
+  case PolicyVariable::Pvalue:
+    return dv.pvalue_;
+  case PolicyVariable::Effect:
+    return dv.effect_;
+  case PolicyVariable::Sig:
+    return dv.sig_;
+  case PolicyVariable::Hacked:
+    return dv.is_hacked_;
+  case PolicyVariable::Candidate:
+    return dv.is_candidate_;
+  }
+  return 0;
+}
+
+/// @brief      A compiled unary policy, e.g., `pvalue < 0.05`, or `sig`
+///
+/// @ingroup    Policies
+struct PolicyPredicate {
+  PolicyVariable var{PolicyVariable::Id};
+  PolicyOperator op{PolicyOperator::Equal};
+  double value{0};
+
+  [[nodiscard]] bool operator()(const DependentVariable &dv) const {
+    const double v = valueOf(dv, var);
+    switch (op) {
+    case PolicyOperator::GreaterEq:
+      return v >= value;
+    case PolicyOperator::LesserEq:
+      return v <= value;
+    case PolicyOperator::Greater:
+      return v > value;
+    case PolicyOperator::Lesser:
+      return v < value;
+    case PolicyOperator::Equal:
+      return v == value;
+    case PolicyOperator::NotEqual:
+      return v != value;
+    }
+    return false;
+  }
+
+  [[nodiscard]] bool operator()(const Submission &sub) const {
+    return (*this)(sub.dv_);
+  }
+};
+
+/// @brief      A compiled binary policy, used by `min`, `max`, `first`, and
+///             `last` functions
+///
+/// @ingroup    Policies
+struct PolicyComparator {
+  PolicyVariable var{PolicyVariable::Id};
+
+  [[nodiscard]] bool operator()(const DependentVariable &l,
+                                const DependentVariable &r) const {
+    return valueOf(l, var) < valueOf(r, var);
+  }
+
+  [[nodiscard]] bool operator()(const Submission &l,
+                                const Submission &r) const {
+    return (*this)(l.dv_, r.dv_);
+  }
+};
+
 /** @name Handy Policy Typedefs
  *
  */
@@ -69,12 +173,22 @@ using PolicyChainSetDefinition = std::vector<std::vector<std::string>>;
 /// - To filter a list of submissions or dependent variables of the experiment
 /// based on the given Policy, you must use the iterator-based operator.
 ///
+/// Policies are compiled into a PolicyPredicate or a PolicyComparator whenever
+/// their definitions fit the policy grammar. Lua is only used as a fallback
+/// for definitions that the native engine cannot handle, e.g., when the
+/// definition contains an arithmetic expression.
+///
 /// @ingroup  Policies
 struct Policy {
   PolicyType type;
   PolicyDefinition def;
   sol::function func;
 
+  //! Indicates whether the policy is evaluated natively, or through Lua
+  bool is_native{false};
+  PolicyPredicate predicate;
+  PolicyComparator comparator;
+
   Policy() = default;
 
   /// Creates a policy, and registers it to the available lua state
@@ -87,21 +201,24 @@ struct Policy {
 
   /// Returns the result of applying the policy on a submission
   [[nodiscard]] bool operator()(const Submission &sub) const {
-    return func(sub);
+    return is_native ? predicate(sub) : func(sub);
   }
 
   /// Returns the result of applying the policy on a dependent variable
   [[nodiscard]] bool operator()(const DependentVariable &dv) const {
-    return func(dv);
+    return is_native ? predicate(dv) : func(dv);
   }
   [[nodiscard]] bool operator()(DependentVariable &dv) const {
-    return func(dv);
+    return is_native ? predicate(dv) : func(dv);
   }
 
   /// String operator for the JSON library
   explicit operator std::string() const { return def; }
 
 private:
+  /// Compiles the definition to a native predicate or comparator
+  bool compile(const std::string &p_def);
+
   std::map<std::string, std::string> lua_temp_scripts{
       {"binary_function_template", "function {} (l, r) return l.{} < r.{} end"},
 
@@ -120,6 +237,17 @@ private:
 
   std::vector<std::string> unary_functions{"min",   "max",  "random",
                                            "first", "last", "all"};
+
+  std::map<std::string, PolicyVariable> native_variables{
+      {"id", PolicyVariable::Id},         {"nobs", PolicyVariable::Nobs},
+      {"mean", PolicyVariable::Mean},     {"pvalue", PolicyVariable::Pvalue},
+      {"effect", PolicyVariable::Effect}, {"sig", PolicyVariable::Sig},
+      {"hacked", PolicyVariable::Hacked}, {"candidate", PolicyVariable::Candidate}};
+
+  std::map<std::string, PolicyOperator> native_operators{
+      {">=", PolicyOperator::GreaterEq}, {"<=", PolicyOperator::LesserEq},
+      {">", PolicyOperator::Greater},    {"<", PolicyOperator::Lesser},
+      {"==", PolicyOperator::Equal},     {"!=", PolicyOperator::NotEqual}};
 };
 
 inline void to_json(json &j, const Policy &p) {
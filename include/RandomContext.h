@@ -0,0 +1,177 @@
+//===-- RandomContext.h - Per-Simulation Random Number Streams ------------===//
+//
+// Part of the SAM Project
+// Created by Amir Masoud Abdol on 2020-11-02.
+//
+//===----------------------------------------------------------------------===//
+///
+/// @file
+/// This file contains the declaration of Xoshiro256, SAM's random number
+/// engine, and the RandomContext, a set of independent random streams derived
+/// from `(master_seed, simid)`.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef SAMPP_RANDOMCONTEXT_H
+#define SAMPP_RANDOMCONTEXT_H
+
+#include <array>
+#include <cstdint>
+#include <limits>
+
+namespace sam {
+
+///
+/// @brief      An implementation of xoshiro256** engine
+///
+/// This is a small, fast, and statistically robust engine with 256 bits of
+/// state. The main reason that I use this instead of `std::mt19937` is its
+/// jump() function, which advances the state by 2^128 steps; therefore, it
+/// can be used to create non-overlapping streams out of one seed.
+///
+/// @note       It satisfies the UniformRandomBitGenerator requirements; so,
+///             it can be used with all `std::*_distribution`s.
+///
+/// @see        https://prng.di.unimi.it
+///
+class Xoshiro256 {
+
+  std::array<std::uint64_t, 4> s_{};
+
+  static constexpr std::uint64_t rotl(std::uint64_t x, int k) {
+    return (x << k) | (x >> (64 - k));
+  }
+
+public:
+  using result_type = std::uint64_t;
+
+  static constexpr result_type default_seed = 0x9E3779B97F4A7C15ULL;
+
+  explicit Xoshiro256(result_type value = default_seed) { seed(value); }
+
+  static constexpr result_type min() {
+    return std::numeric_limits<result_type>::min();
+  }
+
+  static constexpr result_type max() {
+    return std::numeric_limits<result_type>::max();
+  }
+
+  /// Initializes the state using the SplitMix64 sequence of the given value
+  void seed(result_type value) {
+    for (auto &s : s_) {
+      s = splitmix64(value);
+    }
+  }
+
+  result_type operator()() {
+    const result_type result = rotl(s_[1] * 5, 7) * 9;
+    const result_type t = s_[1] << 17;
+
+    s_[2] ^= s_[0];
+    s_[3] ^= s_[1];
+    s_[1] ^= s_[2];
+    s_[0] ^= s_[3];
+
+    s_[2] ^= t;
+    s_[3] = rotl(s_[3], 45);
+
+    return result;
+  }
+
+  /// Advances the state by z steps
+  void discard(unsigned long long z) {
+    for (; z != 0; --z) {
+      (*this)();
+    }
+  }
+
+  /// Advances the state by 2^128 steps
+  void jump();
+
+  /// Advances the state of x, and returns its next SplitMix64 output
+  static result_type splitmix64(result_type &x) {
+    result_type z = (x += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+  }
+
+  friend bool operator==(const Xoshiro256 &lhs, const Xoshiro256 &rhs) {
+    return lhs.s_ == rhs.s_;
+  }
+
+  friend bool operator!=(const Xoshiro256 &lhs, const Xoshiro256 &rhs) {
+    return !(lhs == rhs);
+  }
+};
+
+/// List of independent random streams available in a RandomContext.
+///
+/// Each component draws from its own stream, so, for instance, changing the
+/// hacking workflow does not alter the data generated for a simulation.
+enum class RandomStream : std::size_t {
+  Data,       ///< DataStrategy and Experiment
+  Parameters, ///< Parameter<T>, and ExperimentSetup
+  Researcher, ///< Researcher's decisions
+  Hacking,    ///< HackingStrategy
+  Policy,     ///< Policy's random selection
+  Review,     ///< ReviewStrategy
+  N_STREAMS
+};
+
+///
+/// @brief      A set of random streams belonging to one simulation
+///
+/// All streams are derived from `(master_seed, simid)`. The base engine is
+/// seeded by hashing the pair, and every stream is then one jump() away from
+/// its predecessor. This means that any simulation can be replayed in
+/// isolation, and it can be scheduled on any thread without affecting its
+/// outcome.
+///
+/// Each thread has its own RandomContext, accessible via local(), and the
+/// simulation driver reseeds it before starting a new simulation.
+///
+class RandomContext {
+
+  std::array<Xoshiro256, static_cast<std::size_t>(RandomStream::N_STREAMS)>
+      streams_;
+
+  std::uint64_t master_seed_{0};
+  std::uint64_t simid_{0};
+
+  //! A process-wide unique number of the last seed() call
+  std::uint64_t epoch_{0};
+
+public:
+  RandomContext() { seed(0, 0); }
+
+  RandomContext(std::uint64_t master_seed, std::uint64_t simid) {
+    seed(master_seed, simid);
+  }
+
+  /// Reseeds all streams based on the given master seed and simulation id
+  void seed(std::uint64_t master_seed, std::uint64_t simid);
+
+  [[nodiscard]] std::uint64_t masterSeed() const { return master_seed_; }
+  [[nodiscard]] std::uint64_t simid() const { return simid_; }
+
+  /// Returns a number that changes whenever the context is reseeded, on any
+  /// thread. Stateful objects, e.g., distributions caching their spare
+  /// draws, use it to detect the start of a new simulation.
+  [[nodiscard]] std::uint64_t epoch() const { return epoch_; }
+
+  Xoshiro256 &operator[](RandomStream s) {
+    return streams_[static_cast<std::size_t>(s)];
+  }
+
+  /// Returns the RandomContext of the calling thread
+  static RandomContext &local();
+};
+
+/// Returns the given stream of the calling thread's RandomContext
+inline Xoshiro256 &rng(RandomStream s) { return RandomContext::local()[s]; }
+
+} // namespace sam
+
+#endif // SAMPP_RANDOMCONTEXT_H
@@ -31,8 +31,6 @@
 #include <algorithm>
 #include <utility>
 
-using Random = effolkronium::random_static;
-
 namespace sam {
 
 class ResearcherBuilder;
@@ -10,6 +10,10 @@
 /// a wrapper around DependentVariable. It's being used to pass an outcome
 /// around between Researcher and Journal.
 ///
+/// A Submission is a summary record, and by default it does not hold on to the
+/// raw measurements of its dependent variable, see
+/// Submission::is_retaining_measurements.
+///
 //===----------------------------------------------------------------------===//
 
 #ifndef SAMPP_SUBMISSION_H
@@ -33,6 +37,14 @@ class Submission {
 public:
   static std::vector<std::string> Columns();
 
+  //! Indicates whether Submissions keep the raw measurements of their dependent
+  //! variables. Nothing in SAM's pipeline reads them after the submission is
+  //! made; so, they are being dropped unless this is set, i.e.,
+  //! `retain_submission_measurements` in `simulation_parameters`.
+  //!
+  //! @note This must be set before any simulation starts.
+  static inline bool is_retaining_measurements{false};
+
   //! Simulation ID
   int simid {0};
   //! Experiment ID
@@ -57,6 +69,9 @@ public:
   [[nodiscard]] bool isSig() const { return dv_.sig_; }
   [[nodiscard]] bool isHacked() const { return dv_.is_hacked_; }
   [[nodiscard]] bool isCandidate() const { return dv_.is_candidate_; }
+  [[nodiscard]] bool hasMeasurements() const {
+    return !dv_.measurements().is_empty();
+  }
   ///@}
 
   explicit operator std::map<std::string, std::string>();
@@ -15,6 +15,7 @@
 #include "Experiment.h"
 #include "Distributions.h"
 #include <ostream>
+#include <tuple>
 
 namespace sam {
 
@@ -50,6 +51,26 @@ public:
   ///
   enum class TestAlternative { Less, Greater, TwoSided };
 
+  ///
+  /// @brief      Results of a batch of tests
+  ///
+  /// Each element corresponds to one (control, treatment) pair, and the
+  /// results are stored in a structure-of-arrays layout.
+  ///
+  struct BatchResultType {
+    arma::Row<float> stats;
+    arma::Row<float> df;
+    arma::Row<float> pvalue;
+    arma::urowvec sig;
+
+    void set_size(arma::uword n) {
+      stats.set_size(n);
+      df.set_size(n);
+      pvalue.set_size(n);
+      sig.set_size(n);
+    }
+  };
+
   static std::unique_ptr<TestStrategy> build(json &test_strategy_config);
 
   virtual void run(Experiment *experiment) = 0;
@@ -61,6 +82,11 @@ public:
   virtual float alpha() {
     return alpha_;
   }
+
+protected:
+  /// Writes the batch results to the treatment groups of the experiment, in the
+  /// order of Experiment::stalePairs()
+  static void scatter(Experiment *experiment, const BatchResultType &res);
 };
 
 ///
@@ -143,6 +169,15 @@ public:
   static ResultType two_samples_t_test_unequal_sd(
       float Sm1, float Sd1, unsigned Sn1, float Sm2, float Sd2,
       unsigned Sn2, float alpha, TestStrategy::TestAlternative alternative);
+
+  static void t_test_batch(const arma::Row<float> &Sm1,
+                           const arma::Row<float> &Sd1,
+                           const arma::Row<float> &Sn1,
+                           const arma::Row<float> &Sm2,
+                           const arma::Row<float> &Sd2,
+                           const arma::Row<float> &Sn2, float alpha,
+                           TestStrategy::TestAlternative alternative,
+                           bool equal_var, BatchResultType &res);
 };
 
 ///
@@ -194,6 +229,12 @@ public:
 
   static ResultType f_test(float Sd1, unsigned Sn1, float Sd2, unsigned Sn2,
                     float alpha);
+
+  static void f_test_batch(const arma::Row<float> &Sd1,
+                           const arma::Row<float> &Sn1,
+                           const arma::Row<float> &Sd2,
+                           const arma::Row<float> &Sn2, float alpha,
+                           BatchResultType &res);
 };
 
 ///
@@ -256,6 +297,18 @@ public:
   static ResultType yuen_t_test_two_samples(
       const arma::Row<float> &x, const arma::Row<float> &y, float alpha,
       const TestStrategy::TestAlternative alternative, float trim, float mu);
+
+  static std::tuple<float, float, float> yuen_summary(const arma::Row<float> &x,
+                                                      float trim);
+
+  static void yuen_t_test_batch(const arma::Row<float> &Tm1,
+                                const arma::Row<float> &D1,
+                                const arma::Row<float> &H1,
+                                const arma::Row<float> &Tm2,
+                                const arma::Row<float> &D2,
+                                const arma::Row<float> &H2, float alpha,
+                                const TestStrategy::TestAlternative alternative,
+                                float mu, BatchResultType &res);
 };
 
 ///
@@ -332,6 +385,10 @@ std::pair<float, float>
 confidence_limits_on_mean(float Sm, float Sd, unsigned Sn, float alpha,
                           TestStrategy::TestAlternative alternative);
 
+/// Stats Utility
+void two_samples_t_pvalues(TestStrategy::BatchResultType &res, float alpha,
+                           TestStrategy::TestAlternative alternative);
+
 /// Stats Utility
 float win_var(const arma::Row<float> &x, float trim);
 
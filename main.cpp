@@ -11,16 +11,20 @@
 ///
 //===----------------------------------------------------------------------===//
 
+#include <atomic>
 #include <chrono>
+#include <condition_variable>
 #include <iomanip>
 #include <iostream>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <thread>
 
 #include <boost/filesystem.hpp>
 
 #include "sam.h"
 
-#include "effolkronium/random.hpp"
 #include "nlohmann/json.hpp"
 #include "spdlog/spdlog.h"
 #include "rang/rang.hpp"
@@ -28,6 +32,7 @@
 #include "indicators/indicators.hpp"
 
 #include "PersistenceManager.h"
+#include "RandomContext.h"
 #include "Researcher.h"
 
 using namespace sam;
@@ -35,14 +40,21 @@ using namespace sam;
 #include <boost/program_options.hpp>
 namespace po = boost::program_options;
 
-using Random = effolkronium::random_static;
-
 using namespace std;
 
 bool show_progress_bar{false};
 
 void runSimulation(json &simConfig);
 
+/// Everything that a simulation worker produces during one simulation, and
+/// needs to be handed over to the main thread for IO and aggregation.
+struct SimulationOutput {
+  std::vector<Submission> publications;
+  std::vector<Submission> rejections;
+  std::vector<std::vector<DependentVariable>> experiments;
+  MetaAnalysisResults metas;
+};
+
 /// @brief SAMrun's main routine
 ///
 /// This reads the config file as well as the command line parameters. If
@@ -67,6 +79,9 @@ int main(int argc, const char **argv) {
     (
       "master-seed", po::value<int>()->default_value(42),
       "Set the master seed")
+    (
+      "threads", po::value<int>(),
+      "Number of worker threads, 0 uses all available cores")
     ("output-prefix", po::value<std::string>(),
                              "Output prefix used for saving files")
     (
@@ -155,6 +170,10 @@ int main(int argc, const char **argv) {
   if (vm.count("progress")) {
     show_progress_bar = vm["progress"].as<bool>();
   }
+
+  if (vm.count("threads")) {
+    configs["simulation_parameters"]["n_threads"] = vm["threads"].as<int>();
+  }
   
   // Seeding the RNG
   // ---------------
@@ -184,8 +203,10 @@ int main(int argc, const char **argv) {
   } else {
     master_seed = configs["simulation_parameters"]["master_seed"].get<int>();
   }
-  Random::seed(master_seed);
-  arma::arma_rng::set_seed(master_seed);
+
+  // The main thread's streams are only used while building the Researcher,
+  // every simulation reseeds its own streams from (master_seed, simid).
+  RandomContext::local().seed(master_seed, 0);
 
   // Saving the updated config file, if necessary
   if (vm.count("update-config")) {
@@ -213,23 +234,36 @@ void runSimulation(json &sim_configs) {
   show_progress_bar |=
       sim_configs["simulation_parameters"]["progress"].get<bool>();
 
+  // Keeping an untouched copy of the config for the workers, since building
+  // a Researcher consumes some of the IO related parameters.
+  json workers_configs = sim_configs;
+
   spdlog::info("Initializing the Researcher...");
   Researcher researcher =
       Researcher::create("Sam").fromConfigFile(sim_configs).build();
 
   // Initiate the csvWriter
   // I need an interface for this
+  auto output_format{PersistenceManager::OutputFormat::CSV};
+  if (sim_configs["simulation_parameters"].contains("output_format")) {
+    output_format = sim_configs["simulation_parameters"]["output_format"]
+                        .get<PersistenceManager::OutputFormat>();
+  }
+  const std::string output_ext{
+      output_format == PersistenceManager::OutputFormat::Binary ? ".bin"
+                                                                 : ".csv"};
+
   bool is_saving_all_pubs = sim_configs["simulation_parameters"]["save_all_pubs"];
   std::string pubs_file_name =
       sim_configs["simulation_parameters"]["output_path"].get<std::string>() +
       sim_configs["simulation_parameters"]["output_prefix"].get<std::string>() +
-      "_Publications.csv";
+      "_Publications" + output_ext;
 
   bool is_saving_rejected = sim_configs["simulation_parameters"]["save_rejected"];
   std::string rejs_file_name =
       sim_configs["simulation_parameters"]["output_path"].get<std::string>() +
       sim_configs["simulation_parameters"]["output_prefix"].get<std::string>() +
-      "_Rejected.csv";
+      "_Rejected" + output_ext;
   
   bool is_saving_every_experiment{false};
   std::string exprs_file_name;
@@ -238,7 +272,7 @@ void runSimulation(json &sim_configs) {
     exprs_file_name =
       sim_configs["simulation_parameters"]["output_path"].get<std::string>() +
       sim_configs["simulation_parameters"]["output_prefix"].get<std::string>() +
-      "_Experiments.csv";
+      "_Experiments" + output_ext;
   }
   
 
@@ -250,23 +284,52 @@ void runSimulation(json &sim_configs) {
 
   int n_sims = sim_configs["simulation_parameters"]["n_sims"];
 
+  auto master_seed =
+      sim_configs["simulation_parameters"]["master_seed"].get<std::uint64_t>();
+
+  if (sim_configs["simulation_parameters"].contains(
+          "retain_submission_measurements")) {
+    Submission::is_retaining_measurements =
+        sim_configs["simulation_parameters"]["retain_submission_measurements"];
+  }
+
+  int n_threads{1};
+  if (sim_configs["simulation_parameters"].contains("n_threads")) {
+    n_threads = sim_configs["simulation_parameters"]["n_threads"];
+  }
+  if (n_threads <= 0) {
+    n_threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  n_threads = std::min(n_threads, std::max(n_sims, 1));
+
   std::unique_ptr<PersistenceManager::Writer> pubs_writer;
   std::unique_ptr<PersistenceManager::Writer> rejs_writer;
   std::unique_ptr<PersistenceManager::Writer> experiment_writer;
 
   // Initializing the csv writers
   if (is_saving_all_pubs) {
-    pubs_writer = std::make_unique<PersistenceManager::Writer>(pubs_file_name);
+    pubs_writer = std::make_unique<PersistenceManager::Writer>(pubs_file_name,
+                                                               output_format);
   }
 
   if (is_saving_rejected) {
-    rejs_writer =
-        std::make_unique<PersistenceManager::Writer>(rejs_file_name);
+    rejs_writer = std::make_unique<PersistenceManager::Writer>(rejs_file_name,
+                                                               output_format);
   }
   
   if (is_saving_every_experiment) {
-    experiment_writer = std::make_unique<PersistenceManager::Writer>(exprs_file_name);
+    experiment_writer = std::make_unique<PersistenceManager::Writer>(
+        exprs_file_name, output_format);
+  }
+
+  // All writes are being handed to the persistence thread. It's declared after
+  // the writers; so, it will be drained before they are closed.
+  std::size_t persistence_queue_size{16};
+  if (sim_configs["simulation_parameters"].contains("persistence_queue_size")) {
+    persistence_queue_size =
+        sim_configs["simulation_parameters"]["persistence_queue_size"];
   }
+  PersistenceManager::AsyncWriter persistence{persistence_queue_size};
 
   indicators::show_console_cursor(false);
 
@@ -280,65 +343,237 @@ void runSimulation(json &sim_configs) {
     indicators::option::MaxProgress{n_sims}
   };
 
+  // The persistence jobs only hold on to the Journal's writers, and never to
+  // the Journal itself, which is being used by the simulation in the meantime
+  const auto meta_writers = researcher.journal->metaAnalysisWriters();
+  auto *pubs_per_sim_writer =
+      researcher.journal->publicationsPerSimSummariesWriter();
+
+  // Saves the outcome of the i-th simulation, i.e., whatever is left in
+  // the main Researcher's Journal, and prepares the Journal for the next one.
+  // This is always being performed by the main thread, and the outcomes are
+  // moved out of the Journal, and into the persistence queue.
+  auto saveSimulation = [&](int i) {
+    if (show_progress_bar) sim_progress_bar.tick();
+
+    if (is_saving_all_pubs) {
+      persistence.push(
+          [&pubs_writer, i,
+           pubs = std::move(researcher.journal->publications_list)]() mutable {
+            pubs_writer->write(pubs, i);
+          });
+    }
+
+    if (is_saving_rejected) {
+      persistence.push(
+          [&rejs_writer, i,
+           rejs = std::move(researcher.journal->rejection_list)]() mutable {
+            rejs_writer->write(rejs, i);
+          });
+    }
+
+    if (is_saving_meta) {
+      persistence.push(
+          [&meta_writers,
+           metas = researcher.journal->releaseMetaAnalysisResults()]() mutable {
+            Journal::writeMetaAnalysis(meta_writers, metas);
+          });
+    }
+
+    if (is_saving_pubs_summaries_per_sim) {
+      persistence.push(
+          [pubs_per_sim_writer,
+           record = researcher.journal->publicationsPerSimSummaries()]() {
+            pubs_per_sim_writer->write(record);
+          });
+    }
+
+    researcher.journal->clear();
+  };
+
   
   // Main Simulation Loop
   // --------------------
   
   spdlog::info("Starting the simulation...");
-  for (int i = 0; i < n_sims; ++i) {
+  if (n_threads == 1) {
+    for (int i = 0; i < n_sims; ++i) {
 
-    spdlog::trace("---> Sim {}", i);
+      spdlog::trace("---> Sim {}", i);
 
-    float j{0};
+      RandomContext::local().seed(master_seed, i);
 
-    // Resetting the experiment Id, this is mainly for counting the number of
-    // trial before collecting `k` publications...
-    researcher.experiment->exprid = 0;
+      float j{0};
 
-    researcher.randomizeHackingStrategies();
+      // Resetting the experiment Id, this is mainly for counting the number of
+      // trial before collecting `k` publications...
+      researcher.experiment->exprid = 0;
 
-    // Performing research until Journal doesn't accept anything
-    while (researcher.journal->isStillAccepting()) {
+      researcher.randomizeHackingStrategies();
 
-      spdlog::trace("---> Experiment #{}", j++);
+      // Performing research until Journal doesn't accept anything
+      while (researcher.journal->isStillAccepting()) {
 
-      researcher.research();
+        spdlog::trace("---> Experiment #{}", j++);
 
-      researcher.experiment->exprid++;
-      
-      if (is_saving_every_experiment) {
-        experiment_writer->write(researcher.experiment.get(), i);
+        researcher.research();
+
+        if (is_saving_every_experiment) {
+          auto dvs = researcher.experiment->dvs_;
+          for (auto &dv : dvs) {
+            dv.releaseMeasurements();
+          }
+          persistence.push([&experiment_writer, i,
+                            exprid = researcher.experiment->exprid,
+                            dvs = std::move(dvs)]() {
+            experiment_writer->write(dvs, i, exprid);
+          });
+        }
+
+        researcher.experiment->exprid++;
+
+        spdlog::trace("\n\n===================================================="
+                      "======================\n");
       }
 
-      spdlog::trace("\n\n======================================================"
-                    "====================\n");
-    }
+      researcher.experiment->simid++;
 
-    researcher.experiment->simid++;
+      if (is_saving_summaries or is_saving_meta)
+        researcher.journal->runMetaAnalysis();
 
-    if (show_progress_bar) sim_progress_bar.tick();
+      saveSimulation(i);
+    }
+  } else {
 
-    if (is_saving_all_pubs) {
-      pubs_writer->write(researcher.journal->publications_list, i);
+    // Each worker owns a complete Researcher, i.e., its own Experiment,
+    // Journal, and Lua states. Workers' Journals are not doing any IO, and
+    // they are only collecting the submissions of the current simulation. 
+    workers_configs["simulation_parameters"]["save_meta"] = false;
+    workers_configs["simulation_parameters"]["save_overall_summaries"] = false;
+    workers_configs["simulation_parameters"]["save_pubs_per_sim_summaries"] = false;
+
+    std::vector<Researcher> workers;
+    workers.reserve(n_threads);
+    for (int t{0}; t < n_threads; ++t) {
+      json worker_configs = workers_configs;
+      workers.push_back(
+          Researcher::create("Sam").fromConfigFile(worker_configs).build());
     }
 
-    if (is_saving_rejected) {
-      rejs_writer->write(researcher.journal->rejection_list, i);
+    // Simulations are being claimed dynamically by idle workers, and their
+    // outputs are being buffered until they can be written in order. Workers
+    // are not allowed to run too far ahead of the writer, this keeps the
+    // buffer bounded.
+    std::atomic<int> next_sim{0};
+    int next_to_save{0};
+    const int window = 4 * n_threads;
+    std::map<int, SimulationOutput> finished_sims;
+    std::mutex mtx;
+    std::condition_variable cv;
+
+    auto worker = [&](Researcher &worker_researcher) {
+      for (int i = next_sim++; i < n_sims; i = next_sim++) {
+
+        {
+          std::unique_lock<std::mutex> lock(mtx);
+          cv.wait(lock, [&] { return i < next_to_save + window; });
+        }
+
+        spdlog::trace("---> Sim {}", i);
+
+        // Every simulation has its own streams; therefore, the outcome of a
+        // simulation does not depend on the worker, or the order of execution.
+        RandomContext::local().seed(master_seed, i);
+
+        worker_researcher.experiment->simid = i;
+        worker_researcher.experiment->exprid = 0;
+
+        worker_researcher.randomizeHackingStrategies();
+
+        SimulationOutput output;
+
+        while (worker_researcher.journal->isStillAccepting()) {
+
+          worker_researcher.research();
+
+          worker_researcher.experiment->exprid++;
+
+          if (is_saving_every_experiment) {
+            output.experiments.push_back(worker_researcher.experiment->dvs_);
+            for (auto &dv : output.experiments.back()) {
+              dv.releaseMeasurements();
+            }
+          }
+        }
+
+        if (is_saving_summaries or is_saving_meta) {
+          worker_researcher.journal->runMetaAnalysis();
+        }
+
+        output.publications =
+            std::move(worker_researcher.journal->publications_list);
+        output.rejections = std::move(worker_researcher.journal->rejection_list);
+        output.metas = worker_researcher.journal->releaseMetaAnalysisResults();
+
+        worker_researcher.journal->clear();
+
+        {
+          std::lock_guard<std::mutex> lock(mtx);
+          finished_sims.emplace(i, std::move(output));
+        }
+        cv.notify_all();
+      }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(n_threads);
+    for (auto &w : workers) {
+      threads.emplace_back(worker, std::ref(w));
     }
 
-    if (is_saving_summaries or is_saving_meta)
-      researcher.journal->runMetaAnalysis();
+    // The main thread collects the simulations in order, and takes care of
+    // writing their outputs as well as updating the overall runners.
+    while (next_to_save < n_sims) {
+      SimulationOutput output;
+      {
+        std::unique_lock<std::mutex> lock(mtx);
+        cv.wait(lock, [&] { return finished_sims.count(next_to_save) != 0; });
+        auto node = finished_sims.extract(next_to_save);
+        output = std::move(node.mapped());
+      }
 
-    if (is_saving_meta)
-      researcher.journal->saveMetaAnalysis();
+      if (is_saving_every_experiment) {
+        persistence.push([&experiment_writer, sid = next_to_save,
+                          exprs = std::move(output.experiments)]() {
+          // Every experiment of the simulation is saved; so, their indices
+          // are their exprids
+          for (std::size_t e{0}; e < exprs.size(); ++e) {
+            experiment_writer->write(exprs[e], sid, static_cast<int>(e));
+          }
+        });
+      }
 
-    if (is_saving_pubs_summaries_per_sim) {
-      researcher.journal->savePublicationsPerSimSummaries();
+      researcher.journal->collect(std::move(output.publications),
+                                  std::move(output.rejections),
+                                  std::move(output.metas));
+
+      saveSimulation(next_to_save);
+
+      {
+        std::lock_guard<std::mutex> lock(mtx);
+        ++next_to_save;
+      }
+      cv.notify_all();
     }
 
-    researcher.journal->clear();
+    for (auto &t : threads) {
+      t.join();
+    }
   }
 
+  // Waiting for the persistence thread to flush everything
+  persistence.drain();
+
   if (is_saving_summaries) {
     researcher.journal->saveSummaries();
   }
@@ -2,6 +2,9 @@
 // Created by Amir Masoud Abdol on 2019-10-29
 //
 
+#include <cmath>
+#include <vector>
+
 #include "DataStrategy.h"
 #include "Experiment.h"
 #include "ExperimentSetup.h"
@@ -11,10 +14,7 @@ using namespace sam;
 GRMDataStrategy::GRMDataStrategy(const Parameters &p) : params(p) {
   /// Some initialization
   betas.resize(params.n_items, params.n_categories - 1);
-  poa.resize(params.n_items, params.n_categories - 1);
-  responses.resize(params.n_items, params.n_categories - 1);
-  urand.resize(params.n_items, params.n_categories - 1);
-  scores.resize(params.n_items);
+  exp_betas.resize(params.n_items * (params.n_categories - 1));
 }
 
 void GRMDataStrategy::genData(Experiment *experiment) {
@@ -29,45 +29,72 @@ void GRMDataStrategy::genData(Experiment *experiment) {
   // This is a strange hack, I should redo the GRM totally
   arma::inplace_trans(betas);
   
-  auto thetas = fillMatrix(params.abil_dists, params.m_abil_dist,
-                           experiment->setup.ng(),
-                           experiment->setup.nobs().max());
+  cacheDifficulties();
+  
+  // Abilities of each group are stored in a contiguous column
+  arma::Mat<float> thetas = fillMatrix(params.abil_dists, params.m_abil_dist,
+                                       experiment->setup.ng(),
+                                       experiment->setup.nobs().max());
+  arma::inplace_trans(thetas);
   
   for (int g{0}; g < experiment->setup.ng(); ++g) {
 
     arma::Row<float> data(experiment->setup.nobs()[g]);
-
-    data.imbue([&, i = 0]() mutable {
-      return rasch_score(thetas.at(i++, g));
-    });
+    rasch_scores(thetas.colptr(g), data.n_elem, data.memptr());
 
     (*experiment)[g].setMeasurements(data);
   }
 }
 
-// Generate persons j answer to all items
-float GRMDataStrategy::rasch_score(const float theta) {
-
-  poa = arma::exp(theta - betas);
-  poa = poa / (1 + poa);
-
-  // This is a super slow process, and it's been replaced by `arma::randu()`.
-  // urand.imbue([&]() { return Random::get<float>(0., 1.); });
+void GRMDataStrategy::cacheDifficulties() {
+  const auto n_thresholds = params.n_categories - 1;
   
-  // this is much better but then I'm out of my RNG chain, which should kind of be fine,
-  // because they are just some random values for evaluation,
-  urand.randu();    /// @note this requires arma::arma_rng::set_seed(); to work
+  exp_betas.resize(params.n_items * n_thresholds);
+  for (int i{0}; i < params.n_items; ++i) {
+    for (int k{0}; k < n_thresholds; ++k) {
+      exp_betas[i * n_thresholds + k] = std::exp(betas.at(i, k));
+    }
+  }
+}
 
-  responses = urand < poa;
-  responses.insert_cols(params.n_categories - 1, arma::uvec(params.n_items, arma::fill::zeros));
-  
-  scores.imbue([&, i = 0]() mutable {
-    arma::uvec zeros = arma::find((responses.row(i++)) == 0);
-    return zeros.empty() ? params.n_categories : zeros.at(0);
-  });
-  scores += 1;
-  
-  return arma::accu(scores);
+// Generate the sum scores of n persons over all items
+void GRMDataStrategy::rasch_scores(const float *thetas, std::size_t n,
+                                   float *out) {
+  const auto n_items = static_cast<std::size_t>(params.n_items);
+  const auto n_thresholds = static_cast<std::size_t>(params.n_categories - 1);
+
+  // Drawing directly from the data stream keeps the GRM in the simulation's
+  // RNG chain. One uniform per person and item is sufficient.
+  auto &gen = rng(RandomStream::Data);
+  uniforms.resize(n * n_items);
+  for (auto &u : uniforms) {
+    u = static_cast<float>(gen() >> 40) * 0x1.0p-24f;
+  }
+
+  for (std::size_t j{0}; j < n; ++j) {
+    // p_k = 1 / (1 + exp(β_k) exp(-θ))
+    const float exp_theta = std::exp(-thetas[j]);
+    const float *u = &uniforms[j * n_items];
+
+    float score{0};
+    for (std::size_t i{0}; i < n_items; ++i) {
+      const float *eb = &exp_betas[i * n_thresholds];
+
+      // Probability of reaching the category k + 1
+      float reach{1};
+      std::size_t k{0};
+      for (; k < n_thresholds; ++k) {
+        reach /= 1.f + eb[k] * exp_theta;
+        if (!(u[i] < reach)) {
+          break;
+        }
+      }
+
+      score += k + 1;
+    }
+
+    out[j] = score;
+  }
 }
 
 std::vector<arma::Row<float>>
@@ -76,18 +103,38 @@ GRMDataStrategy::genNewObservationsForAllGroups(Experiment *experiment,
 
   std::vector<arma::Row<float>> new_values(experiment->setup.ng());
 
+  arma::Mat<float> thetas = fillMatrix(params.abil_dists, params.m_abil_dist,
+                                       experiment->setup.ng(),
+                                       n_new_obs);
+  arma::inplace_trans(thetas);
+
   for (int g{0}; g < experiment->setup.ng(); ++g) {
-    new_values[g].resize(n_new_obs);
-
-    auto thetas = fillMatrix(params.abil_dists, params.m_abil_dist,
-                       experiment->setup.ng(),
-                       n_new_obs);
-    
-    new_values[g].imbue([&, i = 0]() mutable {
-      return rasch_score(thetas.at(i++, g));
-    });
+    new_values[g].set_size(n_new_obs);
+    rasch_scores(thetas.colptr(g), n_new_obs, new_values[g].memptr());
   }
 
   return new_values;
 }
 
+/// Participants' abilities are only being drawn for the requested groups,
+/// unless they are coming from a multivariate distribution.
+void GRMDataStrategy::genNewObservationsFor(Experiment *experiment, int begin,
+                                            int end, int n_new_obs,
+                                            arma::Mat<float> &out) {
+
+  if (params.m_abil_dist or !params.abil_dists) {
+    DataStrategy::genNewObservationsFor(experiment, begin, end, n_new_obs, out);
+    return;
+  }
+
+  auto &gen = rng(RandomStream::Data);
+
+  thread_local std::vector<float> thetas;
+  thetas.resize(n_new_obs);
+
+  out.set_size(n_new_obs, end - begin);
+  for (int g{begin}; g < end; ++g) {
+    params.abil_dists.value()[g].fill(gen, thetas.data(), n_new_obs);
+    rasch_scores(thetas.data(), n_new_obs, out.colptr(g - begin));
+  }
+}
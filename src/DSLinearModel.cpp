@@ -2,7 +2,10 @@
 // Created by Amir Masoud Abdol on 2019-01-22.
 //
 
+#include <algorithm>
+#include <functional>
 #include <string>
+#include <vector>
 
 #include <spdlog/spdlog.h>
 
@@ -11,6 +14,27 @@
 
 using namespace sam;
 
+void LinearModelStrategy::drawRandomEffects(Experiment *experiment,
+                                            arma::Mat<float> &sample) {
+  auto &gen = rng(RandomStream::Data);
+
+  const auto t_inxs = experiment->setup.ng() - experiment->setup.nd();
+
+  // Noisy means of the treatment groups, mu ~ N(means, tau2 I)
+  arma::Col<float> noisy_means(t_inxs);
+  fillStandardNormal(gen, noisy_means.memptr(), noisy_means.n_elem);
+  noisy_means = random_effects->means.tail(t_inxs) +
+                random_effects->stddev * noisy_means;
+
+  // Observations, x ~ N(mu, I)
+  arma::Mat<float> random_effect_error(t_inxs, sample.n_cols);
+  fillStandardNormal(gen, random_effect_error.memptr(),
+                     random_effect_error.n_elem);
+  random_effect_error.each_col() += noisy_means;
+
+  sample.tail_rows(t_inxs) = random_effect_error;
+}
+
 void LinearModelStrategy::genData(Experiment *experiment) {
   
   /// Generates the samples
@@ -19,34 +43,8 @@ void LinearModelStrategy::genData(Experiment *experiment) {
                                 experiment->setup.ng(),
                                 experiment->setup.nobs().max());
   
-  if (params.tau2 != 0.) {
-
-    MultivariateDistribution mu_noiser = makeMultivariateDistribution({
-      {"dist", "mvnorm_distribution"},
-      {"means", arma::conv_to<std::vector<float>>::from(params.means)},
-      {"covs", 0},
-      {"stddevs", sqrt(params.tau2)}
-    });
-    
-    arma::Col<float> noisy_means = Random::get(mu_noiser);
-
-    
-    MultivariateDistribution tau2_bar = makeMultivariateDistribution({
-      {"dist", "mvnorm_distribution"},
-      {"means", arma::conv_to<std::vector<float>>::from(noisy_means)},
-      {"covs", 0},
-      {"stddevs", 1}
-    });
-    
-    arma::Mat<float> random_effect_error(experiment->setup.ng(),
-                                         experiment->setup.nobs().max());
-    random_effect_error.each_col([&](arma::Col<float> &v) {
-      v = Random::get(tau2_bar);
-    });
-    
-    auto t_inxs = experiment->setup.ng() - experiment->setup.nd();
-
-    sample.tail_rows(t_inxs) = random_effect_error.tail_rows(t_inxs);
+  if (random_effects) {
+    drawRandomEffects(experiment, sample);
   }
 
   /// Generate the error terms if specified
@@ -75,34 +73,8 @@ LinearModelStrategy::genNewObservationsForAllGroups(Experiment *experiment,
                                 experiment->setup.ng(),
                                 n_new_obs);
   
-  if (params.tau2 != 0.) {
-
-    MultivariateDistribution mu_noiser = makeMultivariateDistribution({
-      {"dist", "mvnorm_distribution"},
-      {"means", arma::conv_to<std::vector<float>>::from(params.means)},
-      {"covs", 0},
-      {"stddevs", sqrt(params.tau2)}
-    });
-    
-    arma::Col<float> noisy_means = Random::get(mu_noiser);
-
-    
-    MultivariateDistribution tau2_bar = makeMultivariateDistribution({
-      {"dist", "mvnorm_distribution"},
-      {"means", arma::conv_to<std::vector<float>>::from(noisy_means)},
-      {"covs", 0},
-      {"stddevs", 1}
-    });
-    
-    arma::Mat<float> random_effect_error(experiment->setup.ng(),
-                                         n_new_obs);
-    random_effect_error.each_col([&](arma::Col<float> &v) {
-      v = Random::get(tau2_bar);
-    });
-    
-    auto t_inxs = experiment->setup.ng() - experiment->setup.nd();
-
-    sample.tail_rows(t_inxs) = random_effect_error.tail_rows(t_inxs);
+  if (random_effects) {
+    drawRandomEffects(experiment, sample);
   }
 
   /// Generate the error terms if specified
@@ -122,3 +94,43 @@ LinearModelStrategy::genNewObservationsForAllGroups(Experiment *experiment,
   return new_values;
 }
 
+
+/// The groups are independent of each other when each has its own univariate
+/// distribution, and then only the requested groups are being drawn. The
+/// multivariate distributions, and the random-effects model, draw every group
+/// jointly.
+void LinearModelStrategy::genNewObservationsFor(Experiment *experiment,
+                                                int begin, int end,
+                                                int n_new_obs,
+                                                arma::Mat<float> &out) {
+
+  if (params.m_meas_dist or params.m_erro_dist or random_effects) {
+    DataStrategy::genNewObservationsFor(experiment, begin, end, n_new_obs, out);
+    return;
+  }
+
+  auto &gen = rng(RandomStream::Data);
+
+  out.set_size(n_new_obs, end - begin);
+  if (!params.meas_dists) {
+    out.zeros();
+  }
+
+  thread_local std::vector<float> errors;
+  errors.resize(n_new_obs);
+
+  for (int g{begin}; g < end; ++g) {
+    float *values = out.colptr(g - begin);
+
+    if (params.meas_dists) {
+      params.meas_dists.value()[g].fill(gen, values, n_new_obs);
+    }
+
+    /// Adding the error terms if specified
+    if (params.erro_dists) {
+      params.erro_dists.value()[g].fill(gen, errors.data(), n_new_obs);
+      std::transform(values, values + n_new_obs, errors.begin(), values,
+                     std::plus<>());
+    }
+  }
+}
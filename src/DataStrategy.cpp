@@ -12,6 +12,18 @@ DataStrategy::~DataStrategy() {
   // Pure destructors
 }
 
+void DataStrategy::genNewObservationsFor(Experiment *experiment, int begin,
+                                         int end, int n_new_obs,
+                                         arma::Mat<float> &out) {
+
+  auto new_observations = genNewObservationsForAllGroups(experiment, n_new_obs);
+
+  out.set_size(n_new_obs, end - begin);
+  for (int g{begin}; g < end; ++g) {
+    out.col(g - begin) = new_observations[g].t();
+  }
+}
+
 std::unique_ptr<DataStrategy> DataStrategy::build(json &data_strategy_config) {
   
   spdlog::debug("Building a Data Strategy");
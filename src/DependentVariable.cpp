@@ -10,19 +10,265 @@
 ///
 //===----------------------------------------------------------------------===// 
 
+#include <algorithm>
+#include <cmath>
+
 #include "DependentVariable.h"
 
 using namespace sam;
 
-/// This updates all the descriptive statistics of the dependent variable
+/// If the buffer is being shared, or it's too small, the viewed values are
+/// being copied into a new buffer from the MeasurementArena, with some extra
+/// room for future observations, see capacityFor().
+void DependentVariable::reserve(std::size_t n) {
+
+  is_dirty_ = true;
+  is_viewing_prefix_ = false;
+
+  const auto n_viewed = view_.size();
+
+  if (buffer_ && buffer_.use_count() == 1 && buffer_.capacity() >= n) {
+    // Dropping the unviewed tail of the buffer, if any
+    buffer_.setSize(n_viewed);
+    return;
+  }
+
+  MeasurementBuffer owned(capacityFor(std::max(n, n_viewed)));
+  if (n_viewed > 0) {
+    std::copy_n((*view_).memptr(), n_viewed, owned.data());
+  }
+  owned.setSize(n_viewed);
+
+  buffer_ = std::move(owned);
+  view_.set(buffer_.data(), n_viewed);
+}
+
+void DependentVariable::setMeasurements(const arma::Row<float> &meas) {
+
+  const auto n = static_cast<std::size_t>(meas.n_elem);
+
+  if (meas.memptr() != buffer_.data() || !view_) {
+    // Nothing needs to be preserved
+    view_.reset();
+    reserve(n);
+    std::copy_n(meas.memptr(), n, buffer_.data());
+  } else {
+    reserve(n);
+  }
+
+  buffer_.setSize(n);
+  view_.set(buffer_.data(), n);
+
+  nobs_ = n;
+  is_stats_synced_ = false;
+
+  // We are basically redefining the values here
+  true_nobs_ = nobs_;
+}
+
+/// The values are being appended into the spare capacity of the buffer, if
+/// there is enough room.
+void DependentVariable::addNewMeasurements(const float *values, std::size_t k) {
+
+  const auto n = view_.size();
+
+  reserve(n + k);
+  std::copy_n(values, k, buffer_.data() + n);
+  buffer_.setSize(n + k);
+  view_.set(buffer_.data(), n + k);
+
+  accumulate(values, k, +1);
+  n_added_obs += k;
+
+  // Keeping the stats up to date
+  updateStats();
+}
+
+/// The remaining values are being compacted in place, while keeping their
+/// order.
+void DependentVariable::removeMeasurements(const arma::uvec &idxs) {
+
+  thread_local std::vector<char> is_removed;
+  thread_local std::vector<float> removed;
+
+  auto &meas = detach();
+  const auto n = static_cast<std::size_t>(meas.n_elem);
+
+  is_removed.assign(n, 0);
+  removed.clear();
+  for (const auto idx : idxs) {
+    if (idx >= n) {
+      throw std::invalid_argument("Index out of bound.");
+    }
+    is_removed[idx] = 1;
+    removed.push_back(meas[idx]);
+  }
+
+  if (is_stats_synced_) {
+    accumulate(removed.data(), removed.size(), -1);
+  }
+
+  float *data = buffer_.data();
+  std::size_t j{0};
+  for (std::size_t i{0}; i < n; ++i) {
+    if (!is_removed[i]) {
+      data[j++] = data[i];
+    }
+  }
+
+  buffer_.setSize(j);
+  view_.set(data, j);
+  n_removed_obs += idxs.n_elem;
+
+  // Keeping the stats up to date
+  updateStats();
+}
+
+/// This updates all the descriptive statistics of the dependent variable.
+///
+/// If the running statistics are in sync with the measurements, e.g., the
+/// measurements have only been changed by addNewMeasurements() or
+/// removeMeasurements(), the statistics are derived from them in O(1);
+/// otherwise, they will be recomputed from the raw measurements.
 void DependentVariable::updateStats() {
 
-  nobs_ = measurements_.size();
-  mean_ = arma::mean(measurements_);
-  var_ = arma::var(measurements_);
-  stddev_ = arma::stddev(measurements_);
+  if (!is_stats_synced_ || nobs_ < 1) {
+    recomputeStats();
+    return;
+  }
+
+  mean_ = static_cast<float>(sum_ / nobs_);
+  var_ = nobs_ > 1 ? static_cast<float>(m2_ / (nobs_ - 1)) : 0.f;
+  stddev_ = std::sqrt(var_);
   sei_ = sqrt(var_ / nobs_);
-  
+
+}
+
+/// This performs a full pass over the measurements, and reinitializes the
+/// running statistics. Besides being the fallback of updateStats(), it can be
+/// used to validate the incrementally updated values.
+void DependentVariable::recomputeStats() {
+
+  const auto &meas = std::as_const(*this).measurements();
+
+  nobs_ = meas.size();
+  mean_ = arma::mean(meas);
+  var_ = arma::var(meas);
+  stddev_ = arma::stddev(meas);
+  sei_ = sqrt(var_ / nobs_);
+
+  sum_ = 0;
+  for (const auto &x : meas) {
+    sum_ += x;
+  }
+
+  m2_ = 0;
+  const double m = nobs_ > 0 ? sum_ / nobs_ : 0;
+  for (const auto &x : meas) {
+    m2_ += (x - m) * (x - m);
+  }
+
+  is_stats_synced_ = true;
+
+}
+
+/// This merges, or removes, a batch of k values into the running statistics
+/// in O(k), using the pairwise update of Chan et al., i.e.,
+///
+/// \f[
+/// M2 = M2_a + M2_b + \delta^2 \frac{n_a n_b}{n_a + n_b}
+/// \f]
+///
+/// where \f$\delta = \bar{x}_b - \bar{x}_a\f$. Removing a batch is the
+/// inverse of the above.
+///
+/// @note If the running statistics are not in sync, this is a no-op, and the
+/// next call to updateStats() recomputes everything, including nobs_.
+void DependentVariable::accumulate(const float *values, std::size_t n,
+                                   int sign) {
+
+  if (!is_stats_synced_ || n == 0) {
+    return;
+  }
+
+  const double n_b = n;
+  double sum_b{0};
+  for (std::size_t i{0}; i < n; ++i) {
+    sum_b += values[i];
+  }
+  const double mean_b = sum_b / n_b;
+
+  double m2_b{0};
+  for (std::size_t i{0}; i < n; ++i) {
+    m2_b += (values[i] - mean_b) * (values[i] - mean_b);
+  }
+
+  if (sign > 0) {
+    const double n_a = nobs_;
+    if (n_a > 0) {
+      const double delta = mean_b - sum_ / n_a;
+      m2_ += m2_b + delta * delta * n_a * n_b / (n_a + n_b);
+    } else {
+      m2_ = m2_b;
+    }
+    sum_ += sum_b;
+    nobs_ += static_cast<int>(n_b);
+  } else {
+    const double n_a = nobs_ - n_b;
+    if (n_a > 0) {
+      const double delta = mean_b - (sum_ - sum_b) / n_a;
+      m2_ -= m2_b + delta * delta * n_a * n_b / (n_a + n_b);
+      // Guarding against the cancellation errors
+      m2_ = std::max(m2_, 0.);
+    } else {
+      m2_ = 0;
+    }
+    sum_ -= sum_b;
+    nobs_ -= static_cast<int>(n_b);
+  }
+
+}
+
+/// This makes the first n values of the buffer, the measurements of the
+/// dependent variable, without copying them. Growing the view only merges the
+/// newly viewed values into the running statistics; so, sweeping over a buffer
+/// of size N in several steps costs O(N) in total. Shrinking the view, or
+/// viewing a buffer that is not in sync, restarts the statistics from the
+/// beginning of the buffer.
+///
+/// The view will be materialized as soon as a mutable access to the
+/// measurements is requested, e.g., by addNewMeasurements().
+///
+/// @note Similar to setMeasurements(), this redefines the true_nobs_.
+///
+/// @param[in]  n     The size of the prefix, it will be clamped to the size of
+///                   the buffer
+void DependentVariable::viewPrefix(int n) {
+
+  n = std::clamp(n, 0, static_cast<int>(buffer_.size()));
+
+  is_dirty_ = true;
+
+  int first{0};
+  if (is_viewing_prefix_ && is_stats_synced_ &&
+      n >= static_cast<int>(view_.size())) {
+    first = view_.size();
+  } else {
+    nobs_ = 0;
+    sum_ = 0;
+    m2_ = 0;
+    is_stats_synced_ = true;
+  }
+
+  accumulate(buffer_.data() + first, n - first, +1);
+
+  // The buffer is not being written through the view, see detach()
+  view_.set(buffer_.data(), n);
+  is_viewing_prefix_ = true;
+
+  true_nobs_ = nobs_;
+
+  updateStats();
 }
 
 /// This is being used by the PersistenceManager::Writer to determine the name
@@ -111,6 +357,10 @@ void DependentVariable::clear() {
   
   n_added_obs = 0;
   n_removed_obs = 0;
+
+  is_dirty_ = true;
   
-  measurements_.clear();
+  // Releasing the buffer rather than clearing it, since it might be shared,
+  // it goes back to the arena otherwise
+  releaseMeasurements();
 }
@@ -14,9 +14,88 @@
 
 #include "Distributions.h"
 
+#include <algorithm>
+#include <cmath>
+
 using namespace sam;
 
-using Generator = std::mt19937;
+///
+/// Draws normals using the Box-Muller transform in two passes over blocks of
+/// the buffer. The uniforms are drawn first, and then they are transformed in
+/// a branch-free loop, which uses both values of every pair, and doesn't go
+/// through the distribution object for each draw.
+///
+/// @note       The transform calls the scalar `std::log`, `std::cos`, and
+///             `std::sin`. Without `-fno-math-errno`, or a vector math
+///             library, the compiler does not vectorise this loop.
+///
+/// @param      gen   The generator
+/// @param      out   The buffer
+/// @param[in]  n     The number of draws
+///
+void fillStandardNormal(Generator &gen, float *out, std::size_t n) {
+  constexpr std::size_t block_size{256};
+  constexpr double two_pi{6.283185307179586};
+  constexpr double to_unit{0x1.0p-53};
+
+  alignas(64) double u1[block_size / 2];
+  alignas(64) double u2[block_size / 2];
+  alignas(64) float z[block_size];
+
+  for (std::size_t start{0}; start < n; start += block_size) {
+    const std::size_t m = std::min(block_size, n - start);
+    const std::size_t n_pairs = (m + 1) / 2;
+
+    // u1 is in (0, 1], so its log is always finite
+    for (std::size_t i{0}; i < n_pairs; ++i) {
+      u1[i] = 1. - static_cast<double>(gen() >> 11) * to_unit;
+      u2[i] = static_cast<double>(gen() >> 11) * to_unit;
+    }
+
+    for (std::size_t i{0}; i < n_pairs; ++i) {
+      const double r = std::sqrt(-2. * std::log(u1[i]));
+      const double theta = two_pi * u2[i];
+      z[2 * i] = static_cast<float>(r * std::cos(theta));
+      z[2 * i + 1] = static_cast<float>(r * std::sin(theta));
+    }
+
+    std::copy_n(z, m, out + start);
+  }
+}
+
+///
+/// @param[in]  sigma  The covariance matrix
+///
+/// @return     The factor of sigma
+///
+arma::Mat<float> covarianceFactor(const arma::Mat<float> &sigma) {
+  arma::Mat<double> cov = arma::conv_to<arma::Mat<double>>::from(sigma);
+
+  arma::Mat<double> L;
+  if (arma::chol(L, cov, "lower")) {
+    return arma::conv_to<arma::Mat<float>>::from(L);
+  }
+
+  arma::Col<double> eigval;
+  arma::Mat<double> eigvec;
+  if (!arma::eig_sym(eigval, eigvec, cov)) {
+    spdlog::critical("Failed to decompose the covariance matrix.");
+    exit(1);
+  }
+
+  // Anything below the round-off of the largest eigenvalue is considered zero,
+  // and a truly negative eigenvalue means that sigma is not a covariance
+  const double tol =
+      eigval.n_elem * arma::fdatum::eps * arma::abs(eigval).max();
+  if (eigval.min() < -tol) {
+    spdlog::critical("The covariance matrix is not positive semi-definite.");
+    exit(1);
+  }
+
+  eigval.clamp(0., arma::datum::inf);
+  L = eigvec * arma::diagmat(arma::sqrt(eigval));
+  return arma::conv_to<arma::Mat<float>>::from(L);
+}
 
 /// @brief      Makes a univariate distribution.
 ///
@@ -31,12 +31,11 @@ EffectStrategy::build(json &effect_strategy_config) {
 
 void CohensD::computeEffects(Experiment *experiment) {
 
-  for (int i{experiment->setup.nd()}, d{0}; i < experiment->setup.ng();
-       ++i, ++d %= experiment->setup.nd()) {
-    auto res =
-        cohens_d((*experiment)[i].mean_, (*experiment)[i].stddev_,
-                 (*experiment)[i].nobs_, (*experiment)[d].mean_,
-                 (*experiment)[d].stddev_, (*experiment)[d].nobs_);
+  const auto &s = experiment->statistics();
+  for (int i : experiment->stalePairs()) {
+    const int d = i % experiment->setup.nd();
+    auto res = cohens_d(s.mean[i], s.stddev[i], s.nobs[i], s.mean[d],
+                        s.stddev[d], s.nobs[d]);
     
     (*experiment)[i].effect_ = res.est;
     (*experiment)[i].effect_var = res.var;
@@ -45,12 +44,13 @@ void CohensD::computeEffects(Experiment *experiment) {
 
 void HedgesG::computeEffects(Experiment *experiment) {
 
+  const auto &s = experiment->statistics();
+
   /// Skipping Treatment groups
-  for (int i{experiment->setup.nd()}, d{0}; i < experiment->setup.ng();
-       ++i, ++d %= experiment->setup.nd()) {
-    auto res = hedges_g((*experiment)[i].mean_, (*experiment)[i].stddev_,
-                        (*experiment)[i].nobs_, (*experiment)[d].mean_,
-                        (*experiment)[d].stddev_, (*experiment)[d].nobs_);
+  for (int i : experiment->stalePairs()) {
+    const int d = i % experiment->setup.nd();
+    auto res = hedges_g(s.mean[i], s.stddev[i], s.nobs[i], s.mean[d],
+                        s.stddev[d], s.nobs[d]);
     
     (*experiment)[i].effect_ = res.est;
     (*experiment)[i].effect_var = res.var;
@@ -59,19 +59,19 @@ void HedgesG::computeEffects(Experiment *experiment) {
 }
 
 void MeanDifference::computeEffects(Experiment *experiment) {
-  for (int i{experiment->setup.nd()}, d{0}; i < experiment->setup.ng();
-       ++i, ++d %= experiment->setup.nd()) {
-    (*experiment)[i].effect_ =
-    mean_difference((*experiment)[i].mean_, (*experiment)[d].mean_);
+  const auto &s = experiment->statistics();
+  for (int i : experiment->stalePairs()) {
+    const int d = i % experiment->setup.nd();
+    (*experiment)[i].effect_ = mean_difference(s.mean[i], s.mean[d]);
   }
 }
 
 void StandardizedMeanDifference::computeEffects(Experiment *experiment) {
-  for (int i{experiment->setup.nd()}, d{0}; i < experiment->setup.ng();
-       ++i, ++d %= experiment->setup.nd()) {
-    auto res =
-        standardized_mean_difference((*experiment)[i].mean_, (*experiment)[i].stddev_,
-                        (*experiment)[d].mean_, (*experiment)[d].stddev_);
+  const auto &s = experiment->statistics();
+  for (int i : experiment->stalePairs()) {
+    const int d = i % experiment->setup.nd();
+    auto res = standardized_mean_difference(s.mean[i], s.stddev[i], s.mean[d],
+                                            s.stddev[d]);
     
     (*experiment)[i].effect_ = res.est;
     (*experiment)[i].effect_var = res.var;
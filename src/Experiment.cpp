@@ -116,30 +116,88 @@ void Experiment::generateCovariants() {
     
     for (int i = 0; i < n_covariants; ++i) {
       covariants.col(i).head((*max_nobs_).nobs_ / 2).fill(1);
-      covariants.col(i) = arma::shuffle(covariants.col(i));
+      std::shuffle(covariants.begin_col(i), covariants.end_col(i),
+                   rng(RandomStream::Data));
     }
     
     is_covariants_generated = true;
   }
 }
 
+///
+/// Only the pairs in stalePairs() are being re-tested.
+///
 void Experiment::calculateTests() {
+  sweepDirtyGroups();
+  collectStalePairs(PendingTests);
+
   test_strategy->run(this);
 }
 
 
+///
+/// Only the dirty dependent variables are being updated.
+///
 void Experiment::calculateStatistics() {
-  
-  std::for_each(dvs_.begin(), dvs_.end(), [](auto &dv){
-    dv.updateStats();
-  });
-  
+  sweepDirtyGroups();
 }
 
+///
+/// Only the pairs in stalePairs() are being re-evaluated.
+///
 void Experiment::calculateEffects() {
+  sweepDirtyGroups();
+  collectStalePairs(PendingEffects);
+
   effect_strategy->computeEffects(this);
 }
 
+///
+/// A dirty control group invalidates every treatment group that is being
+/// compared to it, i.e., groups `i` where `i % nd` is its id, while a dirty
+/// treatment group only invalidates itself. Each pair stays pending until both
+/// the Effect and the Test Strategies have evaluated it, so, the order of
+/// calculateEffects() and calculateTests() doesn't matter.
+///
+void Experiment::sweepDirtyGroups() {
+
+  const int nd = setup.nd();
+  const int ng = setup.ng();
+
+  // New groups, e.g., pooled ones, are dirty anyway
+  pending_.resize(ng, PendingAll);
+  statistics_.resize(std::max<int>(ng, dvs_.size()));
+
+  for (auto &dv : dvs_) {
+    if (!dv.isDirty()) {
+      continue;
+    }
+
+    dv.updateStats();
+    dv.markClean();
+    statistics_.update(dv);
+
+    if (dv.id_ < nd) {
+      for (int i{nd + dv.id_}; i < ng; i += nd) {
+        pending_[i] = PendingAll;
+      }
+    } else if (dv.id_ < ng) {
+      pending_[dv.id_] = PendingAll;
+    }
+  }
+}
+
+void Experiment::collectStalePairs(PendingStage stage) {
+
+  stale_pairs_.clear();
+  for (int i{setup.nd()}; i < setup.ng(); ++i) {
+    if (pending_[i] & stage) {
+      stale_pairs_.push_back(i);
+      pending_[i] &= ~stage;
+    }
+  }
+}
+
 void Experiment::recalculateEverything() {
   
   this->calculateStatistics();
@@ -166,6 +224,15 @@ void Experiment::initResources() {
   std::for_each(dvs_.begin(), dvs_.end(), [i = 0](auto &dv) mutable {
     dv.id_ = i++;
   });
+
+  invalidate();
+
+  // Making sure that the arena of the thread can serve all the groups without
+  // touching the allocator, this is a no-op after the first experiment
+  if (setup.ng() > 0) {
+    MeasurementArena::local().reserve(
+        DependentVariable::capacityFor(setup.nobs().max()), setup.ng());
+  }
 }
 
 
@@ -179,7 +246,7 @@ void Experiment::reset() {
 }
 
 ///
-/// It clears every DVs individually, and also sort them back into the correct order.
+/// It clears every DVs individually.
 ///
 /// @todo I think this is a bad implementation, and I should probably just discard the
 /// list of DVs and recreate them for the new Experiment, which is probably safer!
@@ -191,13 +258,6 @@ void Experiment::clear() {
     dv.clear();
   }
 
-  // This is strange, and I don't want it! It's here because Policy might mess up the
-  // order of DVs when it runs some of the function on a group of them. I think if I use
-  // std::reference_wrapper<T> I can avoid this but that needs some extra work.
-  std::sort(dvs_.begin(), dvs_.end(),
-            [](const auto &l, const auto &r) { return l.id_ < r.id_; });
-  
-  
   has_candidates = false;
   is_hacked = false;
   is_published = false;
@@ -205,33 +265,63 @@ void Experiment::clear() {
 }
 
 
+///
+/// @note The setup is not part of the snapshot, with the exception of the
+/// number of conditions, which can be altered by GroupPooling.
+///
+Experiment::Snapshot Experiment::snapshot() const {
+  return {dvs_, pending_, setup.nc(), is_hacked, has_candidates,
+          is_covariants_generated};
+}
+
+///
+/// Every dependent variable is replaced by its snapshot. Those that have not
+/// been modified since the snapshot are still sharing their measurements with
+/// the snapshot; so, this only drops the modified buffers.
+///
+void Experiment::restore(const Snapshot &snap) {
+  dvs_ = snap.dvs;
+  pending_ = snap.pending;
+
+  // The restored groups are clean, but their statistics might differ from the
+  // ones in the table
+  statistics_.resize(dvs_.size());
+  for (const auto &dv : dvs_) {
+    statistics_.update(dv);
+  }
+
+  if (setup.nc() != snap.nc) {
+    setup.setNC(snap.nc);
+  }
+
+  is_hacked = snap.is_hacked;
+  has_candidates = snap.has_candidates;
+  is_covariants_generated = snap.is_covariants_generated;
+}
+
+
 // Operators
 // ---------
 
 ///
-/// These operators are returning the correct group, even if the group list is
-/// not sorted.
-///
-/// @todo I'm not the fan of this `find_if` here, and I think I can do better.
-/// @todo I think I can avoid this search if I use std::reference_wrapper
+/// The dependent variables are always sorted by their ids, since Policies are
+/// only permuting views of them; so, this is a direct lookup.
 ///
 DependentVariable& Experiment::operator[](std::size_t idx) {
-  if (idx > dvs_.size()) {
+  if (idx >= dvs_.size()) {
     throw std::invalid_argument("Index out of bound.");
   }
   
-  auto g = std::find_if(dvs_.begin(), dvs_.end(), [&](auto &g) -> bool {return g.id_ == idx; });
-  return *g;
+  return dvs_[idx];
 }
 
 ///
 const DependentVariable& Experiment::operator[](std::size_t idx) const {
-  if (idx > dvs_.size()) {
+  if (idx >= dvs_.size()) {
     throw std::invalid_argument("Index out of bound.");
   }
   
-  auto g = std::find_if(dvs_.cbegin(), dvs_.cend(), [&](auto &g) -> bool {return g.id_ == idx; });
-  return *g;
+  return dvs_[idx];
 }
 
 // Getter / Setter / Status Query
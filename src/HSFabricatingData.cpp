@@ -15,6 +15,8 @@
 #include "DataStrategy.h"
 #include "HackingStrategy.h"
 
+#include <utility>
+
 using namespace sam;
 
 void FabricatingData::perform(Experiment *experiment) {
@@ -70,8 +72,9 @@ bool FabricatingData::generate(Experiment *experiment, const int n) {
 
   for (int i = begin; i < end; ++i) {
 
-    static arma::Row<float> new_observations(n, arma::fill::zeros);
-    new_observations.imbue([&]() { return Random::get(params.dist.value()); });
+    thread_local arma::Row<float> new_observations(n, arma::fill::zeros);
+    new_observations.imbue(
+        [&]() { return params.dist.value()(rng(RandomStream::Hacking)); });
 
     experiment->dvs_[i].addNewMeasurements(new_observations);
   }
@@ -98,7 +101,8 @@ bool FabricatingData::duplicate(Experiment *experiment, const int n) {
 
   for (int i = begin; i < end; ++i) {
 
-    arma::Row<float> row = arma::shuffle((*experiment)[i].measurements());
+    arma::Row<float> row = std::as_const(experiment->dvs_[i]).measurements();
+    std::shuffle(row.begin(), row.end(), rng(RandomStream::Hacking));
     arma::Row<float> copy_candidates = row.head(n);
 
     experiment->dvs_[i].addNewMeasurements(copy_candidates);
@@ -127,11 +131,13 @@ bool FabricatingData::manipulate(Experiment *experiment, int n) {
 
   for (int i = begin; i < end; ++i) {
 
-    arma::Row<float> row = arma::shuffle((*experiment)[i].measurements());
+    arma::Row<float> row = std::as_const(experiment->dvs_[i]).measurements();
+    std::shuffle(row.begin(), row.end(), rng(RandomStream::Hacking));
     arma::Row<float> copy_candidates = row.head(n);
 
-    static arma::Row<float> noise(n, arma::fill::zeros);
-    noise.imbue([&]() { return Random::get(params.noise.value()); });
+    thread_local arma::Row<float> noise(n, arma::fill::zeros);
+    noise.imbue(
+        [&]() { return params.noise.value()(rng(RandomStream::Hacking)); });
 
     experiment->dvs_[i].addNewMeasurements(copy_candidates + noise);
   }
@@ -73,12 +73,14 @@ bool FalsifyingData::perturb(Experiment *experiment) {
         static_cast<size_t>(experiment->dvs_[i].measurements().n_elem));
 
     // Selecting n indices randomly
-    arma::uvec shuffled_indices =
-        arma::shuffle(arma::regspace<arma::uvec>(0, 1, row.n_elem - 1));
+    arma::uvec shuffled_indices = arma::regspace<arma::uvec>(0, 1, row.n_elem - 1);
+    std::shuffle(shuffled_indices.begin(), shuffled_indices.end(),
+                 rng(RandomStream::Hacking));
     arma::uvec candidate_indices = shuffled_indices.head(num);
 
-    static arma::Row<float> noise(num, arma::fill::zeros);
-    noise.imbue([&]() { return Random::get(params.noise.value()); });
+    thread_local arma::Row<float> noise(num, arma::fill::zeros);
+    noise.imbue(
+        [&]() { return params.noise.value()(rng(RandomStream::Hacking)); });
 
     row.elem(candidate_indices) += noise;
   }
@@ -114,8 +116,10 @@ bool FalsifyingData::swapGroups(Experiment *experiment) {
     if (params.selection_method == "random") {
       // Shuffling the data because I don't know its status. Better safe than
       // sorry!
-      Random::shuffle(experiment->dvs_[d].measurements());
-      Random::shuffle(experiment->dvs_[i].measurements());
+      auto &d_meas = experiment->dvs_[d].measurements();
+      std::shuffle(d_meas.begin(), d_meas.end(), rng(RandomStream::Hacking));
+      auto &i_meas = experiment->dvs_[i].measurements();
+      std::shuffle(i_meas.begin(), i_meas.end(), rng(RandomStream::Hacking));
     } else { // smart
       experiment->dvs_[d].measurements() =
           arma::sort(experiment->dvs_[d].measurements(), "descend");
@@ -171,7 +175,8 @@ bool FalsifyingData::switchGroups(Experiment *experiment) {
       if (params.selection_method == "random") {
         // Shuffling the data because I don't know its status. Better safe than
         // sorry!
-        Random::shuffle(experiment->dvs_[d].measurements());
+        auto &d_meas = experiment->dvs_[d].measurements();
+        std::shuffle(d_meas.begin(), d_meas.end(), rng(RandomStream::Hacking));
       } else {
         experiment->dvs_[d].measurements() =
             arma::sort(experiment->dvs_[d].measurements(), "descend");
@@ -193,7 +198,8 @@ bool FalsifyingData::switchGroups(Experiment *experiment) {
       if (params.selection_method == "random") {
         // Shuffling the data because I don't know its status. Better safe than
         // sorry!
-        Random::shuffle(experiment->dvs_[i].measurements());
+        auto &i_meas = experiment->dvs_[i].measurements();
+        std::shuffle(i_meas.begin(), i_meas.end(), rng(RandomStream::Hacking));
       } else {
         experiment->dvs_[i].measurements() =
             arma::sort(experiment->dvs_[i].measurements(), "ascend");
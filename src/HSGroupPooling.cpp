@@ -131,7 +131,7 @@ DependentVariable GroupPooling::pool(Experiment *experiment,
 
   // pooling related dvs together across conditions
   for (auto &g : dvs_inx) {
-    grouped_dv.addNewMeasurements(experiment->dvs_[g].measurements());
+    grouped_dv.addNewMeasurements(std::as_const(experiment->dvs_[g]).measurements());
   }
 
   return grouped_dv;
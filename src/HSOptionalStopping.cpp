@@ -11,6 +11,8 @@
 ///
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+
 #include "HackingStrategy.h"
 
 using namespace sam;
@@ -51,6 +53,9 @@ void OptionalStopping::perform(Experiment *experiment) {
   // of using it directly
   int n_at{params.n_attempts};
 
+  // The observations are being drawn lazily, as the attempts need them
+  clearReservoir(experiment, n_at);
+
   for (int t = 0; t < n_at; ++t) {
     spdlog::trace("\t #{} attempt(s)", t + 1);
 
@@ -74,6 +79,12 @@ void OptionalStopping::perform(Experiment *experiment) {
 ///
 /// @brief      Adds new observations to every group
 ///
+/// The observations are being taken from the reservoir, which will only be
+/// grown if one of the target groups doesn't have enough observations left.
+/// So, most attempts are only advancing the ends of the reservoir, and copying
+/// the observations into the spare capacity of the groups' buffers, see
+/// DependentVariable::capacityFor().
+///
 /// @param      experiment  The pointer to the Experiment
 /// @param[in]  ns          Indicates the number of new observations to be added
 ///                         to each group.
@@ -81,20 +92,87 @@ void OptionalStopping::perform(Experiment *experiment) {
 void OptionalStopping::addObservations(Experiment *experiment,
                                        const arma::Row<int> &ns) {
 
-  // Getting max(ns) observations. Sending max to the method is necessary due to
-  // the possibility of dealing with multivariate distribution. After getting
-  // enough observations, I will only add what I need based on ns[i] to each
-  // group
-  auto new_observations =
-      experiment->data_strategy->genNewObservationsForAllGroups(experiment,
-                                                                ns.max());
-
   int begin{0};
   int end{0};
   std::tie(begin, end) = getTargetBounds(experiment, params.target);
 
+  for (int i = begin; i < end; ++i) {
+    const auto r = i - reservoir_begin;
+    if (reservoir_ends[r] + ns.at(i) > reservoir[r].size()) {
+      growReservoir(experiment, ns);
+      break;
+    }
+  }
+
   // Distributing new items according to the requested size
   for (int i = begin; i < end; ++i) {
-    (*experiment)[i].addNewMeasurements(new_observations[i].head(ns.at(i)));
+    const auto r = i - reservoir_begin;
+    if (ns.at(i) > 0) {
+      (*experiment)[i].addNewMeasurements(
+          reservoir[r].data() + reservoir_ends[r], ns.at(i));
+      reservoir_ends[r] += ns.at(i);
+    }
   }
+
+  --n_remaining_attempts;
+}
+
+///
+/// @brief      Empties the reservoir, and prepares it for the target groups
+///
+/// The rows keep their capacity; so, the reservoir doesn't allocate once it
+/// has been used by a few experiments.
+///
+/// @param      experiment  The pointer to the Experiment
+/// @param[in]  n_attempts  The maximum number of attempts
+///
+void OptionalStopping::clearReservoir(Experiment *experiment, int n_attempts) {
+
+  int end{0};
+  std::tie(reservoir_begin, end) = getTargetBounds(experiment, params.target);
+
+  reservoir.resize(end - reservoir_begin);
+  for (auto &row : reservoir) {
+    row.clear();
+  }
+  reservoir_ends.assign(reservoir.size(), 0);
+
+  n_batch_attempts = 1;
+  n_remaining_attempts = n_attempts;
+}
+
+///
+/// @brief      Draws the next batch of observations into the reservoir
+///
+/// Getting max(ns) observations per attempt. Sending max to the method is
+/// necessary due to the possibility of dealing with multivariate distribution.
+/// Each group will only use what it needs based on ns[i].
+///
+/// Only the target groups are being drawn. The first batch covers one attempt,
+/// and every following batch covers twice as many attempts as the previous
+/// one, but never more than the remaining attempts. So, an early stop wastes at
+/// most the unused part of the last batch, while n attempts only need
+/// O(log n) trips to the data strategy.
+///
+/// @param      experiment  The pointer to the Experiment
+/// @param[in]  ns          The number of new observations of each group per
+///                         attempt
+///
+void OptionalStopping::growReservoir(Experiment *experiment,
+                                     const arma::Row<int> &ns) {
+
+  const int n_attempts =
+      std::max(std::min(n_batch_attempts, n_remaining_attempts), 1);
+  const int n_new_obs = ns.max() * n_attempts;
+
+  experiment->data_strategy->genNewObservationsFor(
+      experiment, reservoir_begin,
+      reservoir_begin + static_cast<int>(reservoir.size()), n_new_obs, batch);
+
+  for (std::size_t r{0}; r < reservoir.size(); ++r) {
+    reservoir[r].insert(reservoir[r].end(), batch.colptr(r),
+                        batch.colptr(r) + n_new_obs);
+  }
+
+  n_batch_attempts *= 2;
 }
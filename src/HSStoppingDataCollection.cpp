@@ -10,22 +10,20 @@ void StoppingDataCollection::perform(Experiment *experiment) {
   
   spdlog::debug("Stopping Data Collection: ");
   
-  auto groups = experiment->dvs_;
-  
   int n_obs_max = experiment->setup.nobs().max();
   int n_trials = n_obs_max / params.batch_size;
   
   spdlog::trace("In {} steps...", n_trials);
   
-  /// @todo Check whether this overflow. As I'm using the n_obs_max, there might
-  /// be cases that I don't really get enough observations to add, or I add less, or more
-  /// to a group
+  // Each group is viewing a growing prefix of its own measurements, and only
+  // the newly viewed batch is being added to its statistics. Groups with fewer
+  // than (t + 1) * batch_size observations stay at their full size.
   for (size_t t {0}; t < n_trials; ++t) {
     
     spdlog::trace("Adding {} new items.", (t + 1) * params.batch_size);
     for (int g{0}; g < experiment->setup.ng(); ++g) {
 
-      (*experiment)[g].setMeasurements(groups[g].measurements().head((t + 1) * params.batch_size));
+      (*experiment)[g].viewPrefix((t + 1) * params.batch_size);
     }
     
     experiment->recalculateEverything();
@@ -14,9 +14,71 @@
 
 #include "Journal.h"
 #include <algorithm>
+#include <iterator>
+#include <tuple>
+
+#include <fmt/format.h>
 
 using namespace sam;
 
+namespace {
+
+/// Returns an empty buffer for the results of the given meta-analysis method
+MetaAnalysisBuffer makeMetaAnalysisBuffer(const std::string &name) {
+  if (name == "FixedEffectEstimator") {
+    return std::vector<FixedEffectEstimator::ResultType>{};
+  } else if (name == "RandomEffectEstimator") {
+    return std::vector<RandomEffectEstimator::ResultType>{};
+  } else if (name == "EggersTestEstimator") {
+    return std::vector<EggersTestEstimator::ResultType>{};
+  } else if (name == "TestOfObsOverExptSig") {
+    return std::vector<TestOfObsOverExptSig::ResultType>{};
+  } else if (name == "TrimAndFill") {
+    return std::vector<TrimAndFill::ResultType>{};
+  } else if (name == "RankCorrelation") {
+    return std::vector<RankCorrelation::ResultType>{};
+  }
+
+  spdlog::critical("Invalid Meta Analysis Strategy.");
+  exit(1);
+}
+
+/** @name CSV Formatting of the Meta-analysis Results
+ *
+ *  Values are formatted like `std::to_string`, so, the files are identical to
+ *  the ones written row by row.
+ */
+///@{
+void appendField(fmt::memory_buffer &buf, float value) {
+  fmt::format_to(std::back_inserter(buf), "{:f}", value);
+}
+
+void appendField(fmt::memory_buffer &buf, bool value) {
+  buf.push_back(value ? '1' : '0');
+}
+
+void appendField(fmt::memory_buffer &buf, const std::string &value) {
+  buf.append(value.data(), value.data() + value.size());
+}
+
+/// Appends one line per result, using the ResultType::Fields() of the method
+template <typename ResultType>
+void appendRows(fmt::memory_buffer &buf, const std::vector<ResultType> &rows) {
+  for (const auto &res : rows) {
+    std::apply(
+        [&](auto... fields) {
+          std::size_t c{0};
+          ((c++ > 0 ? buf.push_back(',') : void(), appendField(buf, res.*fields)),
+           ...);
+        },
+        ResultType::Fields());
+    buf.push_back('\n');
+  }
+}
+///@}
+
+} // namespace
+
 std::vector<std::string> Journal::Columns() {
   return {"n_accepted", "n_rejected", "n_sig", "mean_sig_pvalue",
           "mean_sig_effect"};
@@ -49,39 +111,42 @@ Journal::Journal(json &journal_config) {
 
   // For each given method, we prepare their output columns names, and an
   // output file. If we are saving summaries, we initialize a stats runner, as
-  // well as appropriate column names, and output file.
+  // well as appropriate column names, and output file. Everything is indexed
+  // by the method's slot, i.e., its order in the list.
   for (auto const &method : journal_config["meta_analysis_metrics"]) {
 
     // Registering the new strategy
     auto method_name = method["name"].get<std::string>();
     meta_analysis_strategies.push_back(MetaAnalysis::build(method));
+    meta_analysis_strategies.back()->slot = meta_analysis_strategies.size() - 1;
+    meta_analysis_submissions.push_back(makeMetaAnalysisBuffer(method_name));
 
     // Collecting its column name
     auto cols = MetaAnalysis::Columns(method["name"]);
 
     // Registering the method's columns to the list
-    meta_columns.try_emplace(method_name, cols);
+    meta_columns.push_back(cols);
+    meta_stats_runners.emplace_back();
 
     // If saving meta analysis results, we'll create a file for each 
-    // method, and register the writer to the list of meta writers table
-    if (is_saving_meta) {
-      meta_writers.try_emplace(
-          method_name,
-          journal_config["output_path"].get<std::string>() +
-              journal_config["output_prefix"].get<std::string>() + "_" +
-              method_name + ".csv",
-          cols);
-    }
+    // method, and register the writer to the list of meta writers
+    meta_writers.push_back(
+        is_saving_meta
+            ? std::make_unique<PersistenceManager::Writer>(
+                  journal_config["output_path"].get<std::string>() +
+                      journal_config["output_prefix"].get<std::string>() +
+                      "_" + method_name + ".csv",
+                  cols)
+            : nullptr);
 
     // If saving the summaries, ie., the aggregated statistics of each output, 
-    // we register their column names to the column database
+    // we prepare their column names, and a writer for each method
+    std::unique_ptr<PersistenceManager::Writer> stats_writer;
     if (is_saving_summaries) {
-      meta_stats_runners.try_emplace(
-          method_name, arma::running_stat_vec<arma::Row<float>>());
 
       // Prepare the column names for each aggregated method
       std::vector<std::string> meta_stats_cols;
-      for (auto &col : meta_columns[method_name]) {
+      for (auto &col : cols) {
         meta_stats_cols.push_back("mean_" + col);
         meta_stats_cols.push_back("min_" + col);
         meta_stats_cols.push_back("max_" + col);
@@ -89,16 +154,13 @@ Journal::Journal(json &journal_config) {
         //        meta_stats_cols.push_back("stddev_" + col);
       }
 
-      meta_stats_columns[method_name] = meta_stats_cols;
-
-      // and register a writer for each method to the meta summary writer table
-      meta_stats_writers.try_emplace(
-          method_name,
+      stats_writer = std::make_unique<PersistenceManager::Writer>(
           journal_config["output_path"].get<std::string>() +
               journal_config["output_prefix"].get<std::string>() + "_" +
               method_name + "_Summaries.csv",
-          meta_stats_columns[method_name]);
+          meta_stats_cols);
     }
+    meta_stats_writers.push_back(std::move(stats_writer));
   }
 
   // Getting submission's column names
@@ -187,10 +249,23 @@ void Journal::accept(const std::vector<Submission> &subs) {
 
   n_studies++;
 
+  accumulate(subs);
+
   spdlog::trace("Accepted Submissions: {}", subs);
 
 }
 
+void Journal::accumulate(const std::vector<Submission> &subs) {
+  for (const auto &s : subs) {
+    if (meta_sums.add(s.dv_.effect_, s.dv_.var_, s.dv_.sig_)) {
+      yi_pool.push_back(s.dv_.effect_);
+      vi_pool.push_back(s.dv_.var_);
+      ni_pool.push_back(s.dv_.nobs_);
+      sig_pool.push_back(s.dv_.sig_);
+    }
+  }
+}
+
 ///
 /// Adds the rejected submissions to the list of rejected submissions, and keeps
 /// the internal of the Journal up-to-date.
@@ -217,48 +292,103 @@ void Journal::runMetaAnalysis() {
     method->estimate(this);
 
     if (is_saving_summaries) {
-      updateMetaStatsRunners();
+      updateMetaStatsRunners(method->slot);
     }
   }
 }
 
-/// Adds the given meta analysis outcome to the list of collected meta-analysis.
-void Journal::storeMetaAnalysisResult(const MetaAnalysisOutcome &res) {
-  meta_analysis_submissions.push_back(res);
+///
+/// Takes over the outcome of a simulation that has been performed by another
+/// Journal, e.g., a Journal owned by one of the simulation workers, and updates
+/// the stats runners as if the submissions have been reviewed by this Journal.
+///
+/// @param      pubs   The list of accepted submissions
+/// @param      rejs   The list of rejected submissions
+/// @param      metas  The list of meta-analysis results
+///
+void Journal::collect(std::vector<Submission> &&pubs,
+                      std::vector<Submission> &&rejs,
+                      MetaAnalysisResults &&metas) {
+  publications_list = std::move(pubs);
+  rejection_list = std::move(rejs);
+
+  n_accepted = publications_list.size();
+  n_rejected = rejection_list.size();
+
+  accumulate(publications_list);
+
+  for (auto &s : publications_list) {
+    if (is_saving_pubs_per_sim_summaries) {
+      pubs_per_sim_stats_runner(static_cast<arma::Row<float>>(s));
+    }
+
+    if (is_saving_summaries) {
+      pubs_stats_runner(static_cast<arma::Row<float>>(s));
+    }
+  }
+
+  for (std::size_t slot{0}; slot < metas.size(); ++slot) {
+    std::visit(
+        [&](auto &results) {
+          if (is_saving_summaries) {
+            for (auto &res : results) {
+              meta_stats_runners[slot](static_cast<arma::Row<float>>(res));
+            }
+          }
+
+          auto &buffer = std::get<std::decay_t<decltype(results)>>(
+              meta_analysis_submissions[slot]);
+          buffer.insert(buffer.end(), std::make_move_iterator(results.begin()),
+                        std::make_move_iterator(results.end()));
+        },
+        metas[slot]);
+  }
+}
+
+///
+/// Releases the collected results, while keeping the typed buffer of every
+/// slot in place.
+///
+MetaAnalysisResults Journal::releaseMetaAnalysisResults() {
+  auto released = std::exchange(meta_analysis_submissions, {});
+
+  meta_analysis_submissions.reserve(released.size());
+  for (const auto &buffer : released) {
+    std::visit(
+        [&](const auto &results) {
+          meta_analysis_submissions.emplace_back(
+              std::in_place_type<std::decay_t<decltype(results)>>);
+        },
+        buffer);
+  }
+
+  return released;
 }
 
 
 /// 
 /// This prepares the Journal for running meta-analysis. I mainly designed this
 /// to introduce some caching that I don't have to compute everything every
-/// time. So, with this, Journal prepares the #vi, #yi, and #wi once and pass 
-/// them to the meta analysis methods.
+/// time. So, with this, Journal prepares the #yi, #vi, #wi, #ni, and #sigs once
+/// and pass them to the meta analysis methods.
+///
+/// Everything has already been collected by accept(); so, this only copies the
+/// contiguous pools, and studies with zero variance are already left out.
 /// 
 void Journal::prepareForMetaAnalysis() {
-  auto n = publications_list.size();
-  
-  yi.resize(n);
-  vi.resize(n);
-  wi.resize(n);
-  
-  for (int i{0}; i < n; ++i) {
-    yi[i] = publications_list[i].dv_.effect_;
-    vi[i] = publications_list[i].dv_.var_;
-  }
+  yi = arma::Row<float>(yi_pool);
+  vi = arma::Row<float>(vi_pool);
+  ni = arma::Row<float>(ni_pool);
+  sigs = arma::Row<float>(sig_pool);
   
   wi = 1. / vi;
   
-  // This makes sure that no study with zero variance passes to meta-analysis
   // @todo this needs to be handled in a nicer way...
-  if (!wi.is_finite()) {
-    arma::uvec nans = arma::find_nonfinite(wi);
-    yi.shed_cols(nans);
-    vi.shed_cols(nans);
-    wi.shed_cols(nans);
+  if (meta_sums.n_excluded > 0) {
     spdlog::warn(
                  "{} study(-ies) have been removed from meta-analysis pool due to "
                  "unavailability of variance",
-                 nans.n_elem);
+                 meta_sums.n_excluded);
   }
 }
 
@@ -267,7 +397,15 @@ void Journal::prepareForMetaAnalysis() {
 void Journal::clear() {
   publications_list.clear();
   rejection_list.clear();
-  meta_analysis_submissions.clear();
+  for (auto &buffer : meta_analysis_submissions) {
+    std::visit([](auto &results) { results.clear(); }, buffer);
+  }
+  
+  meta_sums.clear();
+  yi_pool.clear();
+  vi_pool.clear();
+  ni_pool.clear();
+  sig_pool.clear();
   
   n_studies = 0;
   n_accepted = 0;
@@ -285,75 +423,54 @@ void Journal::reset() {
   pubs_stats_runner.reset();
 
   // Resets the individual runners
-  std::for_each(meta_stats_runners.begin(), meta_stats_runners.end(), [](auto &item){
-    item.second.reset();
-  });
+  for (auto &runner : meta_stats_runners) {
+    runner.reset();
+  }
 
 }
 
 
-/// Updates the overall meta stats runners
-void Journal::updateMetaStatsRunners() {
-  auto record = meta_analysis_submissions.back();
-
-  std::visit(overload{[&](FixedEffectEstimator::ResultType &res) {
-                        meta_stats_runners["FixedEffectEstimator"](
-                            static_cast<arma::Row<float>>(res));
-                      },
-                      [&](RandomEffectEstimator::ResultType &res) {
-                        meta_stats_runners["RandomEffectEstimator"](
-                            static_cast<arma::Row<float>>(res));
-                      },
-                      [&](EggersTestEstimator::ResultType &res) {
-                        meta_stats_runners["EggersTestEstimator"](
-                            static_cast<arma::Row<float>>(res));
-                      },
-                      [&](TestOfObsOverExptSig::ResultType &res) {
-                        meta_stats_runners["TestOfObsOverExptSig"](
-                            static_cast<arma::Row<float>>(res));
-                      },
-                      [&](TrimAndFill::ResultType &res) {
-                        meta_stats_runners["TrimAndFill"](
-                            static_cast<arma::Row<float>>(res));
-                      },
-                      [&](RankCorrelation::ResultType &res) {
-                        meta_stats_runners["RankCorrelation"](
-                            static_cast<arma::Row<float>>(res));
-                      }},
-             record);
+/// Updates the overall meta stats runners of the given slot with its latest
+/// result
+void Journal::updateMetaStatsRunners(std::size_t slot) {
+  std::visit(
+      [&](auto &results) {
+        meta_stats_runners[slot](static_cast<arma::Row<float>>(results.back()));
+      },
+      meta_analysis_submissions[slot]);
 }
 
 /// Saves the meta analytics results
 void Journal::saveMetaAnalysis() {
-  static std::vector<std::string> mrow;
-
-  for (auto &res : meta_analysis_submissions) {
-    std::visit(overload{[&](FixedEffectEstimator::ResultType &res) {
-                          mrow = res;
-                          meta_writers["FixedEffectEstimator"].write(mrow);
-                        },
-                        [&](RandomEffectEstimator::ResultType &res) {
-                          mrow = res;
-                          meta_writers["RandomEffectEstimator"].write(mrow);
-                        },
-                        [&](EggersTestEstimator::ResultType &res) {
-                          mrow = res;
-                          meta_writers["EggersTestEstimator"].write(mrow);
-                        },
-                        [&](TestOfObsOverExptSig::ResultType &res) {
-                          mrow = res;
-                          meta_writers["TestOfObsOverExptSig"].write(mrow);
-                        },
-                        [&](TrimAndFill::ResultType &res) {
-                          mrow = res;
-                          meta_writers["TrimAndFill"].write(mrow);
-                        },
-                        [&](RankCorrelation::ResultType &res) {
-                          mrow = res;
-                          meta_writers["RankCorrelation"].write(mrow);
-                        }},
-               res);
+  writeMetaAnalysis(metaAnalysisWriters(), meta_analysis_submissions);
+}
+
+/// Writes the given meta analytics results, this allows the results to be
+/// released from the Journal, and written later, e.g., by the persistence
+/// thread.
+///
+/// Each slot is formatted, field by field according to its type, into one
+/// block of rows, and the block is handed to the slot's writer in one call.
+void Journal::writeMetaAnalysis(
+    const std::vector<PersistenceManager::Writer *> &writers,
+    MetaAnalysisResults &results) {
+  thread_local fmt::memory_buffer block;
+
+  for (std::size_t slot{0}; slot < results.size(); ++slot) {
+    block.clear();
+    std::visit([&](const auto &rows) { appendRows(block, rows); },
+               results[slot]);
+    writers[slot]->writeBlock({block.data(), block.size()});
+  }
+}
+
+std::vector<PersistenceManager::Writer *> Journal::metaAnalysisWriters() const {
+  std::vector<PersistenceManager::Writer *> writers;
+  writers.reserve(meta_writers.size());
+  for (const auto &writer : meta_writers) {
+    writers.push_back(writer.get());
   }
+  return writers;
 }
 
 /// Saves the publications and meta stats runners
@@ -366,25 +483,24 @@ void Journal::saveSummaries() {
   record.clear();
 
   // Preparing and writing the summary of every meta-analysis method
-  for (auto &item : meta_stats_runners) {
-    for (int c{0}; c < meta_columns[item.first].size(); ++c) {
-      record["mean_" + meta_columns[item.first][c]] =
-          std::to_string(meta_stats_runners[item.first].mean()[c]);
-      record["min_" + meta_columns[item.first][c]] =
-          std::to_string(meta_stats_runners[item.first].min()[c]);
-      record["max_" + meta_columns[item.first][c]] =
-          std::to_string(meta_stats_runners[item.first].max()[c]);
-      record["var_" + meta_columns[item.first][c]] =
-          std::to_string(meta_stats_runners[item.first].var()[c]);
-
-      //      if (meta_stat_runners[item.first].stddev().empty())
-      //        record["stddev_" + meta_columns[item.first][c]] = "0";
+  for (std::size_t slot{0}; slot < meta_stats_runners.size(); ++slot) {
+    const auto &cols = meta_columns[slot];
+    const auto &runner = meta_stats_runners[slot];
+
+    record.clear();
+    for (int c{0}; c < cols.size(); ++c) {
+      record["mean_" + cols[c]] = std::to_string(runner.mean()[c]);
+      record["min_" + cols[c]] = std::to_string(runner.min()[c]);
+      record["max_" + cols[c]] = std::to_string(runner.max()[c]);
+      record["var_" + cols[c]] = std::to_string(runner.var()[c]);
+
+      //      if (runner.stddev().empty())
+      //        record["stddev_" + cols[c]] = "0";
       //      else
-      //        record["stddev_" + meta_columns[item.first][c]] =
-      //        std::to_string(meta_stat_runners[item.first].stddev()[c]);
+      //        record["stddev_" + cols[c]] = std::to_string(runner.stddev()[c]);
     }
 
-    meta_stats_writers[item.first].write(record);
+    meta_stats_writers[slot]->write(record);
   }
 
   // Cleaning record since I'd need a new set of key-values
@@ -416,7 +532,16 @@ void Journal::saveSummaries() {
 /// @brief Saving the runner statistics of each batch of publications in Journal
 ///
 void Journal::savePublicationsPerSimSummaries() {
-  static std::map<std::string, std::string> record;
+  pubs_per_sim_stats_writer->write(publicationsPerSimSummaries());
+}
+
+///
+/// @brief Preparing the runner statistics of the current batch of publications
+///
+/// @note The runner is being reset afterward.
+///
+std::map<std::string, std::string> Journal::publicationsPerSimSummaries() {
+  std::map<std::string, std::string> record;
 
   for (int c{0}; c < pubs_columns.size(); ++c) {
     record["mean_" + pubs_columns[c]] =
@@ -435,8 +560,8 @@ void Journal::savePublicationsPerSimSummaries() {
     //      std::to_string(pubs_per_sim_stat_runner.stddev()[c]);
   }
 
-  pubs_per_sim_stats_writer->write(record);
-
   /// Resetting the runner statistics
   pubs_per_sim_stats_runner.reset();
+
+  return record;
 }
@@ -0,0 +1,121 @@
+//===-- MeasurementArena.cpp - Pooled Storage of Measurements -------------===//
+//
+// Part of the SAM Project
+// Created by Amir Masoud Abdol on 2020-11-16.
+//
+//===----------------------------------------------------------------------===//
+///
+/// @file
+/// This file contains the implementation of MeasurementArena, and
+/// MeasurementBuffer.
+///
+//===----------------------------------------------------------------------===//
+
+#include "MeasurementArena.h"
+
+#include <algorithm>
+#include <new>
+
+using namespace sam;
+
+namespace {
+
+/// Set once the arena of the thread is destroyed. Blocks that are released
+/// after that, e.g., by static objects, are freed directly.
+thread_local bool is_local_arena_destroyed{false};
+
+MeasurementBlock *newBlock(int size_class) {
+  void *memory = ::operator new(sizeof(MeasurementBlock) +
+                                (std::size_t{1} << size_class) * sizeof(float));
+  auto *block = new (memory) MeasurementBlock;
+  block->size_class = size_class;
+  return block;
+}
+
+void deleteBlock(MeasurementBlock *block) {
+  block->~MeasurementBlock();
+  ::operator delete(block);
+}
+
+} // namespace
+
+int MeasurementArena::sizeClassOf(std::size_t n) {
+  int c{min_size_class};
+  while (c < max_size_class && (std::size_t{1} << c) < n) {
+    ++c;
+  }
+  return c;
+}
+
+MeasurementBlock *MeasurementArena::allocate(std::size_t n) {
+  const int c = sizeClassOf(n);
+
+  auto &blocks = free_[c];
+  if (!blocks.empty()) {
+    auto *block = blocks.back();
+    blocks.pop_back();
+    block->refs.store(1, std::memory_order_relaxed);
+    block->size = 0;
+    return block;
+  }
+
+  return newBlock(c);
+}
+
+void MeasurementArena::deallocate(MeasurementBlock *block) {
+  auto &blocks = free_[block->size_class];
+  if (blocks.size() < max_cached_blocks) {
+    blocks.push_back(block);
+    return;
+  }
+
+  deleteBlock(block);
+}
+
+void MeasurementArena::reserve(std::size_t n, std::size_t count) {
+  const int c = sizeClassOf(n);
+  count = std::min(count, max_cached_blocks);
+
+  auto &blocks = free_[c];
+  blocks.reserve(max_cached_blocks);
+  while (blocks.size() < count) {
+    blocks.push_back(newBlock(c));
+  }
+}
+
+void MeasurementArena::release() {
+  for (auto &blocks : free_) {
+    for (auto *block : blocks) {
+      deleteBlock(block);
+    }
+    blocks.clear();
+  }
+}
+
+std::size_t MeasurementArena::nCachedBlocks() const {
+  std::size_t n{0};
+  for (const auto &blocks : free_) {
+    n += blocks.size();
+  }
+  return n;
+}
+
+MeasurementArena &MeasurementArena::local() {
+  struct LocalArena : MeasurementArena {
+    ~LocalArena() { is_local_arena_destroyed = true; }
+  };
+
+  thread_local LocalArena arena;
+  return arena;
+}
+
+void MeasurementBuffer::reset() {
+  if (block_ && block_->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    if (is_local_arena_destroyed) {
+      deleteBlock(block_);
+    } else {
+      MeasurementArena::local().deallocate(block_);
+    }
+  }
+  block_ = nullptr;
+}
@@ -4,9 +4,15 @@
 
 #include <algorithm>
 #include <cmath>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <numeric>
+#include <vector>
 
 #include <spdlog/spdlog.h>
 #include <fmt/core.h>
+#include <fmt/ranges.h>
 
 #include "sam.h"
 
@@ -18,9 +24,7 @@
 #include <boost/math/distributions/non_central_t.hpp>
 #include <boost/math/distributions/chi_squared.hpp>
 #include <boost/math/special_functions/gamma.hpp>
-#include <boost/math/special_functions/binomial.hpp>
 
-#include <mlpack/methods/linear_regression/linear_regression.hpp>
 
 using namespace std;
 using namespace sam;
@@ -103,24 +107,183 @@ std::vector<std::string> MetaAnalysis::Columns(std::string name) {
 void FixedEffectEstimator::estimate(Journal *journal) {
   spdlog::debug("Computing Fixed Effect Estimate...");
   
-  journal->storeMetaAnalysisResult(FixedEffect(journal->yi, journal->vi));
+  journal->storeMetaAnalysisResult(slot, FixedEffect(journal->meta_sums));
+}
+
+///
+/// Finalizes the fixed-effect model from the running sums of the Journal, which
+/// is equivalent to RandomEffect(yi, vi, 0) but does not need the studies.
+///
+FixedEffectEstimator::ResultType FixedEffectEstimator::FixedEffect(const MetaAnalysisSums &sums) {
+  
+  using boost::math::normal;
+  using boost::math::chi_squared;
+  
+  normal norm(0, 1);
+  
+  RandomEffectEstimator::ResultType res;
+  
+  const double est = sums.est();
+  const double se = sqrt(1. / sums.sw);
+  const double zval = est / se;
+  const double pval_one = cdf(complement(norm, zval));
+  const double q_stat = sums.q();
+  
+  res.est = est;
+  res.se = se;
+  res.ci_lb = est - quantile(norm, 0.975) * se;
+  res.ci_ub = est + quantile(norm, 0.975) * se;
+  res.zval = zval;
+  res.pval = pval_one > 0.5 ? (1. - pval_one) * 2 : pval_one * 2;
+  res.q_stat = q_stat;
+  res.q_pval = cdf(complement(chi_squared(sums.k - 1), q_stat));
+  res.tau2 = 0;
+  
+  return res;
+}
+
+namespace {
+
+/// Weighted sums of the random-effects model at a given tau2, with
+/// wi = 1 / (vi + tau2) and ri = yi - mu
+struct RandomEffectSums {
+  double sw{0};
+  double sw2{0};
+  double sw3{0};
+  double mu{0};
+  
+  //! Generalized Q-statistic, Σ wi ri^2
+  double q{0};
+  
+  //! Σ wi^2 ri^2
+  double sw2r2{0};
+};
+
+/// Computes the RandomEffectSums in two passes over the studies, without
+/// storing the weights
+RandomEffectSums random_effect_sums(const arma::Row<float> &yi,
+                                    const arma::Row<float> &vi, double tau2) {
+  RandomEffectSums s;
+  
+  double swy{0};
+  for (arma::uword i{0}; i < yi.n_elem; ++i) {
+    const double w = 1. / (vi[i] + tau2);
+    s.sw += w;
+    s.sw2 += w * w;
+    s.sw3 += w * w * w;
+    swy += w * yi[i];
+  }
+  s.mu = swy / s.sw;
+  
+  for (arma::uword i{0}; i < yi.n_elem; ++i) {
+    const double w = 1. / (vi[i] + tau2);
+    const double r = yi[i] - s.mu;
+    s.q += w * r * r;
+    s.sw2r2 += w * w * r * r;
+  }
+  
+  return s;
+}
+
+/// Estimates tau2 using Fisher scoring, i.e., Newton's method with the expected
+/// information, and step halving to keep tau2 non-negative
+float fisher_scoring_tau2(const arma::Row<float> &yi, const arma::Row<float> &vi,
+                          float tau2_init, bool restricted) {
+  double tau2 = std::max(0.f, tau2_init);
+  
+  for (int iter{0}; iter < RandomEffectEstimator::max_iterations; ++iter) {
+    const auto s = random_effect_sums(yi, vi, tau2);
+    
+    double score = s.sw2r2 - s.sw;
+    double info = s.sw2;
+    if (restricted) {
+      // tr(P) and tr(PP), with P = W - W11'W / Σw
+      score = s.sw2r2 - (s.sw - s.sw2 / s.sw);
+      info = s.sw2 - 2 * s.sw3 / s.sw + (s.sw2 * s.sw2) / (s.sw * s.sw);
+    }
+    
+    double adj = score / info;
+    if (tau2 == 0 && adj < 0) {
+      break;
+    }
+    while (tau2 + adj < 0) {
+      adj /= 2;
+    }
+    
+    tau2 += adj;
+    
+    if (std::abs(adj) < RandomEffectEstimator::tolerance * (1. + tau2)) {
+      break;
+    }
+  }
+  
+  return tau2;
+}
+
+} // namespace
+
+///
+/// The tau2 estimator is being checked here, rather than when the first
+/// meta-analysis runs, so that a misspelled name stops the simulation before
+/// it starts.
+///
+/// @note       Names used to be matched as substrings, e.g., "DL-estimator"
+///             selected DL. They must now be one of tau2_estimators.
+///
+RandomEffectEstimator::RandomEffectEstimator(const Parameters &p) : params{p} {
+  if (std::find(tau2_estimators.begin(), tau2_estimators.end(),
+                params.estimator) == tau2_estimators.end()) {
+    spdlog::critical("Unknown tau2 estimator: {}, available estimators are: {}",
+                     params.estimator, fmt::join(tau2_estimators, ", "));
+    exit(1);
+  }
 }
 
 void RandomEffectEstimator::estimate(Journal *journal) {
   
   spdlog::debug("Computing Random Effect Estimate...");
   
-  float tau2 {0};
+  float tau2 = params.estimator == "DL" ? journal->meta_sums.tau2DL()
+                                        : Tau2(journal->yi, journal->vi, params.estimator);
   
-  if (params.estimator.find("DL") != std::string::npos){
-    tau2 = RandomEffectEstimator::DL(journal->yi, journal->vi, journal->wi);
-  }else if (params.estimator.find("PM") != std::string::npos){
-    spdlog::critical("Not implemented yet!");
-    exit(1);
-//    tau2 = RandomEffectEstimator::PM(journal->yi, journal->vi, tau2);
+  journal->storeMetaAnalysisResult(slot, RandomEffect(journal->yi, journal->vi, tau2));
+}
+
+float RandomEffectEstimator::Tau2(const arma::Row<float> &yi, const arma::Row<float> &vi, const std::string &estimator) {
+  
+  if (yi.n_elem < 2) {
+    return 0;
+  }
+  
+  // DL estimate using the sums of the fixed-effect model
+  const auto s = random_effect_sums(yi, vi, 0);
+  const float tau2_dl = std::max(0., (s.q - (yi.n_elem - 1)) / (s.sw - s.sw2 / s.sw));
+  
+  if (estimator == "DL") {
+    return tau2_dl;
+  } else if (estimator == "PM") {
+    return PM(yi, vi, tau2_dl);
+  } else if (estimator == "REML") {
+    return REML(yi, vi, tau2_dl);
+  } else if (estimator == "ML") {
+    return ML(yi, vi, tau2_dl);
+  } else if (estimator == "EB") {
+    return EB(yi, vi, tau2_dl);
   }
   
-  journal->storeMetaAnalysisResult(RandomEffect(journal->yi, journal->vi, tau2));
+  spdlog::critical("Unknown tau2 estimator: {}", estimator);
+  exit(1);
+}
+
+std::vector<float> RandomEffectEstimator::Tau2(const std::vector<const Journal *> &journals, const std::string &estimator) {
+  
+  std::vector<float> tau2s;
+  tau2s.reserve(journals.size());
+  for (const auto *journal : journals) {
+    tau2s.push_back(Tau2(journal->yi, journal->vi, estimator));
+  }
+  
+  return tau2s;
 }
 
 
@@ -128,7 +291,7 @@ void EggersTestEstimator::estimate(Journal *journal) {
   
   spdlog::debug("Computing Eggers Estimate...");
   
-  journal->storeMetaAnalysisResult(EggersTest(journal->yi, journal->vi, params.alpha));
+  journal->storeMetaAnalysisResult(slot, EggersTest(journal->yi, journal->vi, params.alpha));
 }
 
 
@@ -187,63 +350,126 @@ float RandomEffectEstimator::DL(const arma::Row<float> &yi, const arma::Row<floa
   return tau2;
 }
 
-// Function for estimating tau2 with Paule-Mandel estimator
-float RandomEffectEstimator::PM(const arma::Row<float> &yi, const arma::Row<float> &vi, const float tau2) {
+///
+/// Paule-Mandel estimator, i.e., the root of Q(tau2) - (k - 1), where Q(tau2)
+/// is the generalized Q-statistic.
+///
+/// Since Q(tau2) is decreasing, with dQ/dtau2 = -Σ wi^2 ri^2, the root is
+/// found by Newton's method, falling back to bisection whenever a step leaves
+/// the current bracket.
+///
+/// @param      tau2_init  The starting point, e.g., the DL estimate
+///
+float RandomEffectEstimator::PM(const arma::Row<float> &yi, const arma::Row<float> &vi, float tau2_init) {
   // Degrees of freedom of Q-statistic (df is also expected value because chi square distributed)
-  auto df = yi.n_elem - 1;
-  // Weights in meta-analysis
-  arma::Row<float> wi = 1. / (vi + tau2);
-  // Meta-analytic effect size
-  auto theta = arma::accu(yi % wi)/arma::accu(wi);
-  // Q-statistic
-  auto Q = arma::accu(wi % arma::pow(yi - theta, 2));
+  const double df = yi.n_elem - 1;
+  
+  auto f = [&](double tau2) { return random_effect_sums(yi, vi, tau2); };
   
-  // Stop iterating if computed Q-statistic equals degrees of freedom
+  if (yi.n_elem < 2 || f(0).q <= df) {
+    return 0;
+  }
+  
+  // Bracketing the root, Q(lo) > df > Q(hi)
+  double lo{0};
+  double hi = std::max(1., 2. * tau2_init);
+  for (int i{0}; i < max_iterations && f(hi).q > df; ++i) {
+    lo = hi;
+    hi *= 2;
+  }
   
-  return (Q - df);
+  double tau2 = (tau2_init > lo && tau2_init < hi) ? tau2_init : (lo + hi) / 2;
+  
+  for (int iter{0}; iter < max_iterations; ++iter) {
+    const auto s = f(tau2);
+    const double fx = s.q - df;
+    
+    // Stop iterating if computed Q-statistic equals degrees of freedom
+    if (fx == 0) {
+      break;
+    }
+    
+    (fx > 0 ? lo : hi) = tau2;
+    
+    double next = tau2 + fx / s.sw2r2;
+    if (!(next > lo && next < hi)) {
+      next = (lo + hi) / 2;
+    }
+    
+    const double adj = next - tau2;
+    tau2 = next;
+    
+    if (std::abs(adj) < tolerance * (1. + tau2)) {
+      break;
+    }
+  }
+  
+  return tau2;
+}
+
+float RandomEffectEstimator::REML(const arma::Row<float> &yi, const arma::Row<float> &vi, float tau2_init) {
+  return fisher_scoring_tau2(yi, vi, tau2_init, true);
+}
+
+float RandomEffectEstimator::ML(const arma::Row<float> &yi, const arma::Row<float> &vi, float tau2_init) {
+  return fisher_scoring_tau2(yi, vi, tau2_init, false);
+}
+
+///
+/// Empirical Bayes estimator. Its estimating equation,
+/// Σ wi (k / (k - 1) ri^2 - vi - tau2) = 0, reduces to Q(tau2) = k - 1 in the
+/// absence of moderators; so, it coincides with the Paule-Mandel estimator.
+///
+float RandomEffectEstimator::EB(const arma::Row<float> &yi, const arma::Row<float> &vi, float tau2_init) {
+  return PM(yi, vi, tau2_init);
 }
 
+///
+/// Egger's regression test, i.e., a weighted regression of yi on sqrt(vi) with
+/// weights 1/vi, and a test of its slope.
+///
+/// The fit and its covariance are computed in closed form. The sandwich
+/// estimator, inv(Z'WZ) (Z'W S W'Z) inv(Z'WZ), with S = diag(sigma^2 / wi)
+/// collapses to sigma^2 inv(Z'WZ); so, for the 2-parameter model only a few
+/// weighted sums are required, and everything is done in two O(n) passes
+/// without forming any n x n matrix.
+///
 EggersTestEstimator::ResultType
 EggersTestEstimator::EggersTest(const arma::Row<float> &yi, const arma::Row<float> &vi, float alpha) {
   
-  using namespace mlpack;
-  
-  using boost::math::students_t;
-  
-  arma::Row<double> Yi = arma::conv_to<arma::Row<double>>::from(yi);
-  arma::Row<double> Vi = arma::conv_to<arma::Row<double>>::from(vi);
-  
-  auto n = Yi.n_elem;
+  const auto n = yi.n_elem;
   auto p = 2;
   float df = n - p;
   
-  arma::Row<double> Wi = 1./Vi;
-  arma::Row<double> wts = arma::sqrt(Wi);
-  arma::Row<double> si = arma::sqrt(Vi);
-  
-  arma::Row<double> predictions(n);
-  
-  arma::Mat<double> X;
-  X.ones(2, n);
-  X.row(1) = si;
-  
-  LinearRegression lg(X, Yi, Wi);
-  lg.Train(X, Yi, Wi, false);
-  lg.Predict(X, predictions);
-  
-  arma::Row<double> errors = Yi - predictions;
-  
-  auto slope = lg.Parameters().at(1);
-  
-  arma::Mat<double> W = arma::diagmat(Wi);
+  // Weighted means of the predictor, si, and the response, yi
+  double sw{0}, sws{0}, swy{0};
+  for (arma::uword i{0}; i < n; ++i) {
+    const double wi = 1. / vi[i];
+    const double si = std::sqrt(static_cast<double>(vi[i]));
+    sw += wi;
+    sws += wi * si;
+    swy += wi * yi[i];
+  }
+  const double s_bar = sws / sw;
+  const double y_bar = swy / sw;
+  
+  // Centered cross-products, Sxx is also 1 / inv(Z'WZ)[1, 1]
+  double sxx{0}, sxy{0}, syy{0};
+  for (arma::uword i{0}; i < n; ++i) {
+    const double wi = 1. / vi[i];
+    const double ds = std::sqrt(static_cast<double>(vi[i])) - s_bar;
+    const double dy = yi[i] - y_bar;
+    sxx += wi * ds * ds;
+    sxy += wi * ds * dy;
+    syy += wi * dy * dy;
+  }
   
-  double res_var_2 = sqrt(arma::accu(Wi % arma::pow(errors, 2)) / (n - 2));
-  arma::Mat<double> S_2 = arma::diagmat(arma::pow(res_var_2 / sqrt(Wi), 2));
+  const double slope = sxy / sxx;
   
-  arma::Mat<double> Z = X.t();
-  arma::Mat<double> var_betas = arma::sqrt(arma::inv(Z.t() * W * Z) * (Z.t() * W * S_2 * W.t() * Z) * arma::inv(Z.t() * W * Z));
+  // Weighted residual variance, i.e., sum(wi * ei^2) / (n - 2)
+  const double sigma2 = std::max(syy - slope * sxy, 0.) / (n - 2);
   
-  double slope_se = var_betas.diag().at(1);
+  double slope_se = std::sqrt(sigma2 / sxx);
   
   double slope_stat = slope / slope_se;
   
@@ -302,43 +528,115 @@ void TestOfObsOverExptSig::estimate(Journal *journal) {
   
   spdlog::debug("Computing Test Of Obs Over Expt Significance...");
   
-  float beta = FixedEffectEstimator::FixedEffect(journal->yi, journal->vi).est;
+  float beta = journal->meta_sums.est();
   
-  arma::Row<float> sigs(journal->yi.n_elem);
-  sigs.imbue([&, i = 0]() mutable {
-    return journal->publications_list[i++].dv_.sig_;
-  });
+  journal->storeMetaAnalysisResult(slot, TestOfObsOverExptSig::TES(journal->sigs, journal->ni, beta, 0.05));
+}
+
+void TrimAndFill::estimate(Journal *journal) {
   
-  arma::Row<float> ni(journal->yi.n_elem);
-  ni.imbue([&, i = 0]() mutable {
-    return journal->publications_list[i++].dv_.nobs_;
-  });
+  spdlog::debug("Computing Trim And Fill...");
   
+  journal->storeMetaAnalysisResult(slot, TrimAndFill::TF(journal->yi, journal->vi, params));
+}
+
+void TrimAndFill::Workspace::resize(std::size_t k) {
+  ix.resize(k);
+  yi_s.resize(k);
+  cum_wi.resize(k + 1);
+  cum_wyi.resize(k + 1);
+}
+
+TrimAndFill::Workspace &TrimAndFill::Workspace::local() {
+  thread_local Workspace ws;
+  return ws;
+}
+
+namespace {
+
+/// Ranks the absolute centered values, |yi_s - beta|, using the average ranks
+/// for ties, and returns the largest rank of the negative centered values,
+/// and the sum of ranks of the positive ones.
+///
+/// Since `yi_s` is sorted, the absolute centered values are already sorted on
+/// each side of beta; so, they are ranked by merging the two sides outward,
+/// starting from beta, without any sorting.
+std::pair<float, float> signed_ranks_summary(const std::vector<float> &yi_s,
+                                             int k, float beta) {
+  int r = static_cast<int>(std::lower_bound(yi_s.begin(), yi_s.begin() + k, beta) -
+                           yi_s.begin());
+  int l = r - 1;
+  
+  int n_ranked{0};
+  float max_neg_rank{0};
+  float sum_pos_ranks{0};
+  
+  while (l >= 0 || r < k) {
+    const float d = (r == k || (l >= 0 && -(yi_s[l] - beta) < yi_s[r] - beta))
+                        ? -(yi_s[l] - beta)
+                        : yi_s[r] - beta;
+    
+    int n_neg{0}, n_pos{0}, n_tied{0};
+    for (; l >= 0 && -(yi_s[l] - beta) == d; --l, ++n_tied) {
+      ++n_neg;
+    }
+    for (; r < k && yi_s[r] - beta == d; ++r, ++n_tied) {
+      n_pos += (d > 0);
+    }
+    
+    const float rank = n_ranked + (n_tied + 1) / 2.f;
+    if (n_neg > 0) {
+      max_neg_rank = rank;
+    }
+    sum_pos_ranks += n_pos * rank;
+    n_ranked += n_tied;
+  }
   
-  journal->storeMetaAnalysisResult(TestOfObsOverExptSig::TES(sigs, ni, beta, 0.05));
+  return {max_neg_rank, sum_pos_ranks};
 }
 
-void TrimAndFill::estimate(Journal *journal) {
+} // namespace
+
+TrimAndFill::ResultType TrimAndFill::TF(const arma::Row<float> &yi, const arma::Row<float> &vi, const Parameters &params) {
+  return TF(yi, vi, params, Workspace::local());
+}
+
+std::vector<TrimAndFill::ResultType> TrimAndFill::TF(const std::vector<const Journal *> &journals, const Parameters &params) {
   
-  spdlog::debug("Computing Trim And Fill...");
+  auto &ws = Workspace::local();
   
-  arma::Row<float> ni(journal->yi.n_elem);
-  ni.imbue([&, i = 0]() mutable {
-    return journal->publications_list[i++].dv_.nobs_;
-  });
+  std::vector<ResultType> results;
+  results.reserve(journals.size());
+  for (const auto *journal : journals) {
+    results.push_back(TF(journal->yi, journal->vi, params, ws));
+  }
   
-  journal->storeMetaAnalysisResult(TrimAndFill::TF(journal->yi, journal->vi, ni, params));
+  return results;
 }
 
-TrimAndFill::ResultType TrimAndFill::TF(arma::Row<float> yi, arma::Row<float> vi, arma::Row<float> ni, const Parameters &params) {
+///
+/// All fixed-effect estimates of the procedure are being computed from the
+/// prefix sums of the sorted weights and weighted effect sizes, e.g., the
+/// estimate of the truncated data is `cum_wyi[k - k0] / cum_wi[k - k0]`, and
+/// the filled-in studies, being the mirror images of the k0 largest studies
+/// around beta, only add `2 * beta * Σw - Σwy` of those studies.
+///
+TrimAndFill::ResultType TrimAndFill::TF(const arma::Row<float> &yi, const arma::Row<float> &vi, const Parameters &params, Workspace &ws) {
   
   int k = yi.n_elem;
-  arma::Row<float> wi = 1. / vi;
+  ws.resize(k);
+  
+  double sum_wi{0};
+  double sum_wyi{0};
+  for (int i{0}; i < k; ++i) {
+    sum_wi += 1. / vi[i];
+    sum_wyi += yi[i] / vi[i];
+  }
   
   std::string side = params.side;
 
   /// Determining the side
-  float beta = FixedEffectEstimator::FixedEffect(yi, vi).est;
+  float beta = sum_wyi / sum_wi;
   
   if (params.side.find("auto") != std::string::npos) {
     if (beta < 0) {
@@ -349,16 +647,22 @@ TrimAndFill::ResultType TrimAndFill::TF(arma::Row<float> yi, arma::Row<float> vi
   }
   
   /// flip data if examining right side
-  if (side.find("right") != std::string::npos){
-    yi = -1. * yi;
-  }
+  const float flip = side.find("right") != std::string::npos ? -1. : 1.;
   
   /// sort data by increasing yi
-  arma::uvec ix = arma::sort_index(yi);
-  arma::Row<float> yi_s = yi.elem(ix).as_row();
-  arma::Row<float> vi_s = vi.elem(ix).as_row();
-  arma::Row<float> wi_s = wi.elem(ix).as_row();
-  arma::Row<float> ni_s = wi.elem(ix).as_row();
+  std::iota(ws.ix.begin(), ws.ix.end(), 0);
+  std::sort(ws.ix.begin(), ws.ix.end(), [&](arma::uword a, arma::uword b) {
+    return flip * yi[a] < flip * yi[b] || (flip * yi[a] == flip * yi[b] && a < b);
+  });
+  
+  ws.cum_wi[0] = 0;
+  ws.cum_wyi[0] = 0;
+  for (int i{0}; i < k; ++i) {
+    const auto j = ws.ix[i];
+    ws.yi_s[i] = flip * yi[j];
+    ws.cum_wi[i + 1] = ws.cum_wi[i] + 1. / vi[j];
+    ws.cum_wyi[i + 1] = ws.cum_wyi[i] + ws.yi_s[i] / vi[j];
+  }
   
   int iter{0};
   int maxiter{100};
@@ -366,13 +670,7 @@ TrimAndFill::ResultType TrimAndFill::TF(arma::Row<float> yi, arma::Row<float> vi
   float k0_sav{-1};
   float k0{0}; // estimated number of missing studies;
   float se_k0{0};
-  float Sr{0};
   float varSr{0};
-  float k0_pval{0};
-  
-  arma::Row<float> yi_c;
-  arma::Row<float> yi_c_r;
-  arma::Row<float> yi_c_r_s;
   
   while (abs(k0 - k0_sav) > 0) {
     
@@ -383,32 +681,20 @@ TrimAndFill::ResultType TrimAndFill::TF(arma::Row<float> yi, arma::Row<float> vi
     if (iter > maxiter)
       break;
     
-    //  truncated data
-    arma::uvec elems = arma::regspace<arma::uvec>(0, 1, k - k0 - 1);
-    arma::Row<float> yi_t = yi_s.elem(elems).as_row();
-    arma::Row<float> vi_t = vi_s.elem(elems).as_row();
-    arma::Row<float> wi_t = wi_s.elem(elems).as_row();
-    arma::Row<float> ni_t = wi_s.elem(elems).as_row();
-    
     //  intercept estimate based on truncated data
-    beta = FixedEffectEstimator::FixedEffect(yi_t, vi_t).est;
+    const auto k_t = static_cast<std::size_t>(k - k0);
+    beta = ws.cum_wyi[k_t] / ws.cum_wi[k_t];
     
-    yi_c     = yi_s - beta;                             ///  centered values;
-    yi_c_r   = rankdata(abs(yi_c), "average").as_row(); /// @todo ties_method="first"); //  ranked absolute centered values;
-    yi_c_r_s = arma::sign(yi_c) % yi_c_r;               ///  signed ranked centered values;
+    auto [max_neg_rank, Sr] = signed_ranks_summary(ws.yi_s, k, beta);
     
     //  estimate the number of missing studies with the R0 estimator
-    
     if (params.estimator.find("R0") != std::string::npos) {
-      arma::uvec inx = arma::find(yi_c_r_s < 0);
-      k0 = (k - arma::max(-1. * yi_c_r_s.elem(inx))) - 1;
+      k0 = (k - max_neg_rank) - 1;
       se_k0 = sqrt(2 * std::max(static_cast<float>(0.), k0) + 2);
     }
     
     ///  estimate the number of missing studies with the L0 estimator
     if (params.estimator.find("L0") != std::string::npos) {
-      arma::uvec inx = arma::find(yi_c_r_s > 0);
-      Sr = arma::accu(yi_c_r_s.elem(inx));
       k0 = (4.*Sr - k*(k+1.)) / (2.*k - 1.);
       varSr = 1./24 * (k*(k+1.)*(2.*k+1.) + 10.*pow(k0,3) + 27.*pow(k0,2) + 17.*k0 - 18.*k*pow(k0,2) - 18.*k*k0 + 6.*pow(k,2)*k0);
       se_k0 = 4.*sqrt(varSr) / (2*k - 1);
@@ -416,8 +702,6 @@ TrimAndFill::ResultType TrimAndFill::TF(arma::Row<float> yi, arma::Row<float> vi
     
     ///  estimate the number of missing studies with the Q0 estimator
     if (params.estimator.find("Q0") != std::string::npos) {
-      arma::uvec inx = arma::find(yi_c_r_s > 0);
-      Sr = arma::accu(yi_c_r_s.elem(inx));
       k0 = k - 1./2 - sqrt(2*pow(k,2) - 4.*Sr + 1./4);
       varSr = 1./24 * (k*(k+1.)*(2*k+1.) + 10.*pow(k0,3) + 27.*pow(k0,2) + 17.*k0 - 18.*k*pow(k0,2) - 18.*k*k0 + 6.*pow(k,2)*k0);
       se_k0 = 2. * sqrt(varSr) / sqrt(pow(k-0.5,2) - k0*(2.*k - k0 - 1.));
@@ -429,185 +713,186 @@ TrimAndFill::ResultType TrimAndFill::TF(arma::Row<float> yi, arma::Row<float> vi
     
   }
   
-  
-  
   /// ------------------ Filling and estimating ----------------
   
-  auto res = FixedEffectEstimator::FixedEffect(yi, vi);
-  float imputed_est = res.est;
-  float imputed_pval = res.pval;
+  /// filled-in studies, mirrored around beta, and flipped back if side is right
+  const auto k_t = static_cast<std::size_t>(k - k0);
+  const double fill_wi = ws.cum_wi[k] - ws.cum_wi[k_t];
+  const double fill_wyi = flip * (2. * beta * fill_wi - (ws.cum_wyi[k] - ws.cum_wyi[k_t]));
   
-  /// if estimated number of missing studies is > 0
-  if (k0 > 0) {
-    
-    /// flip data back if side is right
-    if (side.find("right") != std::string::npos) {
-      yi_c = -1 * (yi_c - beta);
-      yi = -1 * yi;
-    } else {
-      yi_c = yi_c - beta;
-    }
-    
-    /// create filled-in data set
-    arma::Row<float> yi_f = yi_c;
-    arma::Row<float> yi_fill = yi;
-    yi_fill.insert_cols(yi_f.n_elem, -1. * yi_c.elem(arma::regspace<arma::uvec>(k - k0, 1, k - 1)).as_row());
-    
-    /// apply limits if specified
-    /// @todo: to be implemented
-    //    if (!missing(ilim)) {
-    //      ilim = sort(ilim)
-    //      if (length(ilim) != 2L)
-    //        stop(mstyle$stop("Argument 'ilim' must be of length 2_"))
-    //        yi_fill[yi_fill < ilim[1]] = ilim[1]
-    //        yi_fill[yi_fill > ilim[2]] = ilim[2]
-    //        }
-    
-    arma::Row<float> vi_fill = vi;
-    vi_fill.insert_cols(vi.n_elem, vi.elem(arma::regspace<arma::uvec>(k - k0, 1, k - 1)).as_row());
-    arma::Row<float> wi_fill = wi;
-    wi_fill.insert_cols(wi.n_elem, wi.elem(arma::regspace<arma::uvec>(k - k0, 1, k - 1)).as_row());
-    arma::Row<float> ni_fill = ni;
-    ni_fill.insert_cols(ni.n_elem, ni.elem(arma::regspace<arma::uvec>(k - k0, 1, k - 1)).as_row());
-    
-    
-    /// fit model with imputed data
-    auto res = FixedEffectEstimator::FixedEffect(yi_fill, vi_fill);
-    imputed_est = res.est;
-    imputed_pval = res.pval;
-    
-  }
-    
-  /// @todo need to be integrated!
-  std::optional<float> p_k0;
-  
-  /// Adjustment for p_k0
-  if (params.estimator.find("R0") != std::string::npos) {
-    arma::Row<float> m {arma::regspace<arma::Row<float>>(-1, 1, (k0-1))};
-    arma::Row<float> bin_coefs(m.n_elem);
-    /// @todo This imbue can be improved
-    bin_coefs.imbue([&, i = 0]() mutable {
-      auto x = boost::math::binomial_coefficient<float>(0+m.at(i)+1, m.at(i)+1);
-      i++;
-      return x;
-    });
-    arma::Row<float> tmp(m.n_elem);
-    tmp.imbue([&, i = 0]() mutable {
-      return pow(0.5, static_cast<int>(0 + m.at(i++) + 2));
-    });
-    p_k0 = 1 - arma::accu(bin_coefs % tmp);
-  } //else
-    // p_k0 = NA
+  /// @todo: apply limits, i.e., ilim, if specified
+  
+  /// fit model with imputed data
+  boost::math::normal norm(0, 1);
+  const double sw = sum_wi + fill_wi;
+  const double imputed_est = (sum_wyi + fill_wyi) / sw;
+  const double pval_one = cdf(complement(norm, imputed_est * sqrt(sw)));
+  const double imputed_pval = pval_one > 0.5 ? (1. - pval_one) * 2 : pval_one * 2;
   
   /// @todo Still need to report the p_k0
-  return ResultType{.k0 = k0, .se_k0 = se_k0, .k_all = k + k0, .side = side, .imputed_est = imputed_est, .imputed_pval = imputed_pval};
+  return ResultType{.k0 = k0, .se_k0 = se_k0, .k_all = k + k0, .side = side, .imputed_est = static_cast<float>(imputed_est), .imputed_pval = static_cast<float>(imputed_pval)};
   
 }
 
 namespace sam {
 
+namespace {
+
+/// Sorts v[lo, hi) using the merge sort, and returns the number of inversions,
+/// i.e., pairs with v[i] > v[j] and i < j. Ties are not counted.
+std::uint64_t count_inversions(std::vector<float> &v, std::vector<float> &buf,
+                               std::size_t lo, std::size_t hi) {
+  if (hi - lo < 2) {
+    return 0;
+  }
+
+  const std::size_t mid = lo + (hi - lo) / 2;
+  std::uint64_t swaps = count_inversions(v, buf, lo, mid) +
+                        count_inversions(v, buf, mid, hi);
+
+  std::size_t i{lo}, j{mid}, k{lo};
+  while (i < mid && j < hi) {
+    if (v[j] < v[i]) {
+      swaps += mid - i;
+      buf[k++] = v[j++];
+    } else {
+      buf[k++] = v[i++];
+    }
+  }
+  std::copy(v.begin() + i, v.begin() + mid, buf.begin() + k);
+  std::copy(v.begin() + j, v.begin() + hi, buf.begin() + k + (mid - i));
+  std::copy(buf.begin() + lo, buf.begin() + hi, v.begin() + lo);
+
+  return swaps;
+}
+
+/// Returns the number of tied pairs of a sorted sequence
+template <typename ForwardIt, typename Equal>
+std::uint64_t count_tied_pairs(ForwardIt first, ForwardIt last, Equal equal) {
+  std::uint64_t ties{0};
+  while (first != last) {
+    auto next = std::find_if_not(first, last, [&](const auto &v) { return equal(*first, v); });
+    const std::uint64_t t = std::distance(first, next);
+    ties += t * (t - 1) / 2;
+    first = next;
+  }
+  return ties;
+}
+
+} // namespace
+
 /*-------------------------------------------------------------------------
  * This function calculates the Kendall correlation tau_b.
  *
- * from: https://afni.nimh.nih.gov/pub/dist/src/ktaub.c
+ * It uses Knight's O(n log n) algorithm, i.e., sorting by (x, y), and then
+ * counting the discordant pairs as the number of swaps needed for merge
+ * sorting y, see Knight, W. R. (1966). A Computer Method for Calculating
+ * Kendall's Tau with Ungrouped Data.
  */
 float kendallcor(const arma::Row<float> &x, const arma::Row<float> &y) {
   
   spdlog::debug(" → Computing Kendall Correlation...");
   
-  int len = x.n_elem;
+  const std::size_t len = x.n_elem;
   
-  int m1 = 0, m2 = 0, s = 0, nPair , i,j ;
-  float cor ;
+  std::vector<std::size_t> idx(len);
+  std::iota(idx.begin(), idx.end(), 0);
+  std::sort(idx.begin(), idx.end(), [&](auto i, auto j) {
+    return x[i] < x[j] || (x[i] == x[j] && y[i] < y[j]);
+  });
   
-  for(i = 0; i < len; i++) {
-    for(j = i + 1; j < len; j++) {
-      if(y[i] > y[j]) {
-        if (x[i] > x[j]) {
-          s++;
-        } else if(x[i] < x[j]) {
-          s--;
-        } else {
-          m1++;
-        }
-      } else if(y[i] < y[j]) {
-        if (x[i] > x[j]) {
-          s--;
-        } else if(x[i] < x[j]) {
-          s++;
-        } else {
-          m1++;
-        }
-      } else {
-        m2++;
-        
-        if(x[i] == x[j]) {
-          m1++;
-        }
-      }
-    }
-  }
+  // Ties in x, and joint ties in (x, y)
+  const auto m1 = count_tied_pairs(idx.begin(), idx.end(),
+                                   [&](auto i, auto j) { return x[i] == x[j]; });
+  const auto m3 = count_tied_pairs(idx.begin(), idx.end(), [&](auto i, auto j) {
+    return x[i] == x[j] && y[i] == y[j];
+  });
+  
+  std::vector<float> ys(len), buf(len);
+  std::transform(idx.begin(), idx.end(), ys.begin(), [&](auto i) { return y[i]; });
+  
+  const auto swaps = count_inversions(ys, buf, 0, len);
   
-  nPair = len * (len - 1) / 2;
+  // Ties in y, ys is sorted now
+  const auto m2 = count_tied_pairs(ys.begin(), ys.end(), std::equal_to<>());
   
-  if( m1 < nPair && m2 < nPair )
-    cor = s / ( sqrtf((float)(nPair-m1)) * sqrtf((float)(nPair-m2)) );
-  else
-    cor = 0.0f;
+  const std::uint64_t nPair = static_cast<std::uint64_t>(len) * (len - 1) / 2;
+  
+  if (m1 < nPair && m2 < nPair) {
+    const double s = static_cast<double>(nPair) - m1 - m2 + m3 - 2. * swaps;
+    return s / (std::sqrt(static_cast<double>(nPair - m1)) *
+                std::sqrt(static_cast<double>(nPair - m2)));
+  }
   
-  return cor;
+  return 0.0f;
 }
 
-float ckendall(int k, int n, arma::Mat<float> &w) {
-  int i, u;
-  float s;
+///
+/// Returns the cumulative null distribution of Kendall's statistic, i.e., the
+/// number of inversions of a random permutation of n elements.
+///
+/// The distribution is computed by convolving the uniform distribution of
+/// each element's inversions, in O(n^3), and it's being cached per n; so,
+/// simulations with the same number of publications share the same table.
+///
+const std::vector<double> &kendall_null_distribution(int n) {
+  thread_local std::map<int, std::vector<double>> tables;
+  
+  auto [it, is_new] = tables.try_emplace(n);
+  auto &cdf = it->second;
+  if (!is_new) {
+    return cdf;
+  }
   
-  u =  (n * (n - 1) / 2);
-  if ((k < 0) || (k > u))
-    return(0);
+  const std::size_t u = static_cast<std::size_t>(n) * (n - 1) / 2;
+  std::vector<double> pdf(u + 1, 0.), next(u + 1, 0.), prefix(u + 2, 0.);
+  pdf[0] = 1.;
   
-  if (w.at(n, k) < 0) {
-    if (n == 1)
-      w.at(n, k) = (k == 0);
-    else {
-      s = 0;
-      for (i = 0; i < n; i++)
-        s += ckendall(k - i, n - 1, w);
-      w.at(n, k) = s;
+  // Adding the m-th element adds 0, ..., m - 1 inversions with equal chance
+  for (int m{2}; m <= n; ++m) {
+    const std::size_t top = static_cast<std::size_t>(m) * (m - 1) / 2;
+    for (std::size_t k{0}; k <= top; ++k) {
+      prefix[k + 1] = prefix[k] + pdf[k];
+    }
+    for (std::size_t k{0}; k <= top; ++k) {
+      const std::size_t lo = k >= static_cast<std::size_t>(m - 1) ? k - (m - 1) : 0;
+      next[k] = (prefix[k + 1] - prefix[lo]) / m;
     }
+    std::swap(pdf, next);
   }
-  return(w.at(n, k));
+  
+  cdf.resize(u + 1);
+  std::partial_sum(pdf.begin(), pdf.end(), cdf.begin());
+  
+  return cdf;
 }
 
-float pkendall(int len, int n) {
+/// Returns the probability of observing at most q concordant pairs in a
+/// sample of size n under the null hypothesis.
+float pkendall(int q, int n) {
   
   spdlog::debug(" → Computing Kendall Probability...");
   
-  int i, j;
-  float p, q;
-  
-  p = 0;
-  q = len;
+  float p{0};
   
-  size_t u =  (n * (n - 1) / 2);
-  arma::Mat<float> w(n, u); w.fill(-1);
-
-    if (q < 0)
-      p = 0;
-    else if (q > (n * (n - 1) / 2))
-      p = 1;
-    else {
-      p = 0;
-      for (j = 0; j <= q; j++)
-        p += ckendall(j, n, w);
-      p = p / boost::math::tgamma(n + 1);
-    }
+  if (q < 0) {
+    p = 0;
+  } else if (q >= n * (n - 1) / 2) {
+    p = 1;
+  } else {
+    p = std::min(kendall_null_distribution(n)[q], 1.);
+  }
   
   spdlog::trace(" → → p = {:f}\n", p);
   return p;
 }
 
-std::pair<float, float> kendall_cor_test(const arma::Row<float> &x, const arma::Row<float> &y, const TestStrategy::TestAlternative alternative) {
+///
+/// @note Similar to R's `cor.test`, the exact p-value is only computed if there
+/// are no ties and n < exact_threshold; otherwise, the normal approximation is
+/// being used.
+///
+std::pair<float, float> kendall_cor_test(const arma::Row<float> &x, const arma::Row<float> &y, const TestStrategy::TestAlternative alternative, int exact_threshold) {
   
   spdlog::debug(" → Running Kendall Correlation Test...");
   
@@ -626,7 +911,7 @@ std::pair<float, float> kendall_cor_test(const arma::Row<float> &x, const arma::
   float p{0};
   float statistic;
   
-  if (!ties) {
+  if (!ties && n < exact_threshold) {
     
     statistic = q;
     spdlog::trace(" → → Statistic: {}", q);
@@ -651,8 +936,10 @@ std::pair<float, float> kendall_cor_test(const arma::Row<float> &x, const arma::
   }else{
     /// @note I'm not 100% sure if this is a good replacement for `table` but it seems to
     /// be working!
-    spdlog::trace("Found ties...");
-    spdlog::warn("Cannot compute exact p-value with ties!");
+    if (ties) {
+      spdlog::trace("Found ties...");
+      spdlog::warn("Cannot compute exact p-value with ties!");
+    }
     
     /// xties <- table(x[duplicated(x)]) + 1;
     arma::urowvec xties;
@@ -742,6 +1029,6 @@ RankCorrelation::ResultType RankCorrelation::RankCor(arma::Row<float> yi, arma::
 }
 
 void RankCorrelation::estimate(sam::Journal *journal) { 
-  journal->storeMetaAnalysisResult(RankCorrelation::RankCor(journal->yi, journal->vi, params));
+  journal->storeMetaAnalysisResult(slot, RankCorrelation::RankCor(journal->yi, journal->vi, params));
 }
 
@@ -0,0 +1,92 @@
+//===-- PValueService.cpp - Cached Student's t Probabilities --------------===//
+//
+// Part of the SAM Project
+// Created by Amir Masoud Abdol on 2020-11-09.
+//
+//===----------------------------------------------------------------------===//
+///
+/// @file
+/// This file contains the implementation of PValueService.
+///
+//===----------------------------------------------------------------------===//
+
+#include "PValueService.h"
+
+#include <cmath>
+
+#include <boost/math/distributions/students_t.hpp>
+
+using namespace sam;
+using boost::math::students_t;
+
+///
+/// The table of a new df is being built right away. Since it's identical to
+/// the one that has been evicted, dropping the cache doesn't change any value.
+///
+const PValueService::Entry &PValueService::entry(float df) {
+  auto it = entries_.find(df);
+  if (it != entries_.end()) {
+    return it->second;
+  }
+
+  if (entries_.size() >= max_entries) {
+    entries_.clear();
+  }
+
+  auto &e = entries_[df];
+  buildTable(e, df);
+  return e;
+}
+
+///
+/// Tabulates the upper tail, Q(t), and its derivative, -pdf(t), on a regular
+/// grid of [0, table_max].
+///
+void PValueService::buildTable(Entry &e, float df) {
+  students_t dist(df);
+
+  const auto n = static_cast<std::size_t>(table_max * table_resolution) + 1;
+  e.tail.resize(n);
+  e.dtail.resize(n);
+
+  for (std::size_t i{0}; i < n; ++i) {
+    const double t = static_cast<double>(i) / table_resolution;
+    e.tail[i] = boost::math::cdf(complement(dist, t));
+    e.dtail[i] = -boost::math::pdf(dist, t);
+  }
+}
+
+///
+/// @note       For negative t, Q(t) = 1 - Q(|t|) is at least one half; so, no
+///             precision is lost by only tabulating the positive half.
+///
+double PValueService::upperTail(double t, float df) {
+  const double x = std::fabs(t);
+
+  if (!isTabulated(df) || !(x < table_max)) {
+    return boost::math::cdf(complement(students_t(df), t));
+  }
+
+  const auto &e = entry(df);
+
+  // Cubic Hermite interpolation between the two surrounding nodes
+  const double u = x * table_resolution;
+  const auto i = static_cast<std::size_t>(u);
+  const double s = u - i;
+  const double h = 1. / table_resolution;
+
+  const double s2 = s * s;
+  const double s3 = s2 * s;
+
+  const double q = (2 * s3 - 3 * s2 + 1) * e.tail[i] +
+                   (s3 - 2 * s2 + s) * h * e.dtail[i] +
+                   (-2 * s3 + 3 * s2) * e.tail[i + 1] +
+                   (s3 - s2) * h * e.dtail[i + 1];
+
+  return t < 0 ? 1. - q : q;
+}
+
+PValueService &PValueService::local() {
+  thread_local PValueService service;
+  return service;
+}
@@ -52,14 +52,14 @@ Parameter<T>::Parameter(const json &j, size_t size) {
       if (multivariate_dists.find(name) != multivariate_dists.end()) {
         // Multivariate Distribution
         dist = makeMultivariateDistribution(j);
-        auto v = Random::get(std::get<2>(dist));
+        auto v = std::get<2>(dist)(rng(RandomStream::Parameters));
         val.imbue([&, i = 0]() mutable {
           return static_cast<T>(v[i++]);
         });
       } else if (univariate_dists.find(name) != univariate_dists.end()) {
         // Univariate Distribution
         dist = makeUnivariateDistribution(j);
-        auto v = static_cast<T>(Random::get(std::get<1>(dist)));
+        auto v = static_cast<T>(std::get<1>(dist)(rng(RandomStream::Parameters)));
         val = arma::Col<T>(std::vector<T>(size, v));
       }
     } break;
@@ -90,11 +90,11 @@ void Parameter<T>::randomize() {
   if (dist.index() != 0) {
     std::visit(overload {
       [&](UnivariateDistribution &d) {
-        auto v = static_cast<T>(Random::get(d));
+        auto v = static_cast<T>(d(rng(RandomStream::Parameters)));
         this->fill(v);
       },
       [&](MultivariateDistribution &md) {
-        auto v = Random::get(md);
+        auto v = md(rng(RandomStream::Parameters));
         this->imbue([&, i = 0]() mutable {
           return static_cast<T>(v[i++]);
         });
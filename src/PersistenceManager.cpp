@@ -15,12 +15,96 @@
 
 using namespace sam;
 
+namespace {
+
+using ColumnType = PersistenceManager::ColumnarWriter::ColumnType;
+
+/// Types of the DependentVariable::Columns()
+const std::vector<ColumnType> dv_column_types{
+    ColumnType::Int32,   ColumnType::Int32,   ColumnType::Int32,
+    ColumnType::Float32, ColumnType::Float32, ColumnType::Float32,
+    ColumnType::Float32, ColumnType::Float32, ColumnType::Float32,
+    ColumnType::Float32, ColumnType::Float32, ColumnType::Bool,
+    ColumnType::Bool,    ColumnType::Bool};
+
+/// Types of the Submission::Columns()
+std::vector<ColumnType> submissionColumnTypes() {
+  std::vector<ColumnType> types(4, ColumnType::Int32);
+  types.insert(types.end(), dv_column_types.begin(), dv_column_types.end());
+  return types;
+}
+
+} // namespace
+
+PersistenceManager::ColumnarWriter::ColumnarWriter(const std::string &filename,
+                                                   std::uint32_t chunk_size)
+    : out_(filename, std::ios::binary | std::ios::trunc),
+      chunk_size_{chunk_size} {
+  if (!out_) {
+    spdlog::critical("Cannot open {} for writing.", filename);
+    exit(1);
+  }
+}
+
+PersistenceManager::ColumnarWriter::~ColumnarWriter() {
+  flush();
+}
+
+void PersistenceManager::ColumnarWriter::setSchema(
+    const std::vector<std::string> &names,
+    const std::vector<ColumnType> &types) {
+
+  if (names.size() != types.size()) {
+    throw std::invalid_argument(
+        "The number of column names doesn't match the number of types.");
+  }
+
+  out_.write("SAMCOL01", 8);
+  put(static_cast<std::uint32_t>(names.size()));
+
+  columns_.clear();
+  for (std::size_t i{0}; i < names.size(); ++i) {
+    put(static_cast<std::uint8_t>(types[i]));
+    put(static_cast<std::uint16_t>(names[i].size()));
+    out_.write(names[i].data(), names[i].size());
+
+    columns_.push_back({names[i], types[i], {}});
+    columns_.back().buffer.reserve(chunk_size_ * 4);
+  }
+}
+
+void PersistenceManager::ColumnarWriter::flush() {
+  if (n_rows_ == 0) {
+    return;
+  }
+
+  put(n_rows_);
+  for (auto &col : columns_) {
+    out_.write(col.buffer.data(), col.buffer.size());
+    col.buffer.clear();
+  }
+  n_rows_ = 0;
+
+  out_.flush();
+}
+
 PersistenceManager::Writer::Writer(const std::string &filename)
     : file_name_(filename) {
   writer = std::make_unique<csv::Writer>(file_name_);
   writer->configure_dialect().delimiter(",");
 }
 
+PersistenceManager::Writer::Writer(const std::string &filename,
+                                   OutputFormat format)
+    : file_name_(filename) {
+  if (format == OutputFormat::Binary) {
+    columnar = std::make_unique<ColumnarWriter>(file_name_);
+  } else {
+    writer = std::make_unique<csv::Writer>(file_name_);
+    writer->configure_dialect().delimiter(",");
+  }
+}
+
 PersistenceManager::Writer::Writer(const std::string &filename, const std::vector<std::string> colnames)
     : file_name_(filename), column_names(colnames) {
       writer = std::make_unique<csv::Writer>(file_name_);
@@ -32,7 +116,9 @@ PersistenceManager::Writer::Writer(const std::string &filename, const std::vecto
 
 PersistenceManager::Writer::~Writer() {
   spdlog::info("Saved {}", file_name_);
-  writer->close();
+  if (writer) {
+    writer->close();
+  }
 }
 
 void PersistenceManager::Writer::write(const std::map<std::string, std::string> &row) {
@@ -43,10 +129,38 @@ void PersistenceManager::Writer::write(const std::vector<std::string> &row_entri
   writer->write_row(row_entries);
 }
 
+/// The csv::Writer terminates every entry that it receives; so, the block is
+/// passed without its last line break.
+void PersistenceManager::Writer::writeBlock(std::string_view rows) {
+  if (rows.empty()) {
+    return;
+  }
+
+  rows.remove_suffix(1);
+  writer->write_row(std::vector<std::string>{std::string(rows)});
+}
+
 void PersistenceManager::Writer::write(std::vector<Submission> &subs, int simid) {
 
   int i = 0;
 
+  if (columnar) {
+    if (!columnar->hasSchema()) {
+      columnar->setSchema(Submission::Columns(), submissionColumnTypes());
+    }
+
+    for (const auto &s : subs) {
+      const auto &dv = s.dv_;
+      columnar->writeRow(s.simid, s.exprid, s.repid, i++, dv.id_,
+                         dv.true_nobs_, dv.nobs_, dv.mean_, dv.var_,
+                         dv.stddev_, dv.sei_, dv.pvalue_, dv.effect_,
+                         dv.effect_var, dv.effect_sei, dv.sig_, dv.is_hacked_,
+                         dv.is_candidate_);
+    }
+
+    return;
+  }
+
   /// @todo This looks strange, and it's also very inefficient! Optimize it!
   /// It's somewhat better than &&s, but not great yet!
   for (auto &s : subs) {
@@ -66,15 +180,41 @@ void PersistenceManager::Writer::write(std::vector<Submission> &subs, int simid)
 
 
 void PersistenceManager::Writer::write(Experiment *expr, int sid) {
-  int i = 0;
+  write(expr->dvs_, sid, expr->exprid);
+}
+
+
+void PersistenceManager::Writer::write(const std::vector<DependentVariable> &dvs,
+                                       int sid, int exprid) {
   
-  for (auto &dv : expr->dvs_) {
+  if (columnar) {
+    if (!columnar->hasSchema()) {
+      auto cols = DependentVariable::Columns();
+      cols.insert(cols.begin(), {"simid", "exprid"});
+      auto types = dv_column_types;
+      types.insert(types.begin(), 2, ColumnType::Int32);
+      columnar->setSchema(cols, types);
+    }
+
+    for (const auto &dv : dvs) {
+      columnar->writeRow(sid, exprid, dv.id_, dv.true_nobs_, dv.nobs_,
+                         dv.mean_, dv.var_, dv.stddev_, dv.sei_, dv.pvalue_,
+                         dv.effect_, dv.effect_var, dv.effect_sei, dv.sig_,
+                         dv.is_hacked_, dv.is_candidate_);
+    }
+
+    return;
+  }
+
+  for (auto &dv : dvs) {
     if (!is_header_set) {
       writer->configure_dialect().column_names(Submission::Columns());
       is_header_set = true;
     }
     
     std::map<std::string, std::string> record{dv};
+    record["simid"] = std::to_string(sid);
+    record["exprid"] = std::to_string(exprid);
     
     writer->write_row(record);
   }
@@ -86,6 +226,79 @@ void PersistenceManager::Writer::setColumnNames(const std::vector<std::string> &
   writer->configure_dialect().column_names(colnames);
 }
 
+PersistenceManager::AsyncWriter::AsyncWriter(std::size_t capacity)
+    : capacity_{capacity} {
+  if (capacity_ > 0) {
+    worker_ = std::thread(&AsyncWriter::loop, this);
+  }
+}
+
+PersistenceManager::AsyncWriter::~AsyncWriter() {
+  if (!worker_.joinable()) {
+    return;
+  }
+
+  drain();
+  {
+    std::lock_guard lock(mutex_);
+    is_stopping_ = true;
+  }
+  has_jobs_.notify_one();
+  worker_.join();
+}
+
+void PersistenceManager::AsyncWriter::push(std::function<void()> job) {
+  if (capacity_ == 0) {
+    job();
+    return;
+  }
+
+  {
+    std::unique_lock lock(mutex_);
+    has_space_.wait(lock, [&] { return jobs_.size() < capacity_; });
+    jobs_.push_back(std::move(job));
+  }
+  has_jobs_.notify_one();
+}
+
+void PersistenceManager::AsyncWriter::drain() {
+  if (capacity_ == 0) {
+    return;
+  }
+
+  std::unique_lock lock(mutex_);
+  is_idle_.wait(lock, [&] { return jobs_.empty() && !is_busy_; });
+}
+
+void PersistenceManager::AsyncWriter::loop() {
+  while (true) {
+    std::function<void()> job;
+    {
+      std::unique_lock lock(mutex_);
+      has_jobs_.wait(lock, [&] { return !jobs_.empty() || is_stopping_; });
+
+      if (jobs_.empty()) {
+        return;
+      }
+
+      job = std::move(jobs_.front());
+      jobs_.pop_front();
+      is_busy_ = true;
+    }
+    has_space_.notify_one();
+
+    job();
+
+    {
+      std::lock_guard lock(mutex_);
+      is_busy_ = false;
+      if (jobs_.empty()) {
+        is_idle_.notify_all();
+      }
+    }
+  }
+}
+
 PersistenceManager::Reader::Reader(const std::string &filename)
     : file_name_(filename) {
   reader = std::make_unique<csv::Reader>();
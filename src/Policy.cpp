@@ -12,13 +12,19 @@
 //===----------------------------------------------------------------------===//
 
 #include "Policy.h"
+#include "RandomContext.h"
+
+#include <cctype>
+#include <cstdlib>
 
 using namespace sam;
 
 ///
-/// This mostly performs some string search, and decided what type of function
-/// has been given as the input. Then, it uses a lua function template to
-/// construct the appropriate function definition. Finally, it registers the
+/// This first tries to compile the definition into a native predicate or
+/// comparator, see compile(). If the definition is not supported by the native
+/// engine, it mostly performs some string search, and decided what type of
+/// function has been given as the input. Then, it uses a lua function template
+/// to construct the appropriate function definition. Finally, it registers the
 /// function to the given lua state.
 ///
 /// @attention Since everything is happening via text processing, Policy is
@@ -30,6 +36,11 @@ using namespace sam;
 ///
 Policy::Policy(const std::string &p_def, sol::state &lua) {
 
+  if (compile(p_def)) {
+    spdlog::trace("Native Policy: {}", p_def);
+    return;
+  }
+
   std::string f_def;
 
   if (p_def.find("min") != std::string::npos) {
@@ -197,6 +208,109 @@ Policy::Policy(const std::string &p_def, sol::state &lua) {
   spdlog::trace("Lua Function: {}", f_def);
 }
 
+///
+/// Compiles the policy definition into a flat PolicyPredicate or
+/// PolicyComparator. The native engine supports the entire policy grammar,
+/// i.e., comparisons between any of the #quantitative_variables or
+/// #meta_variables with a numeric value, the meta variables and their
+/// negations, and all the #unary_functions.
+///
+/// @param[in]  p_def  The policy definition
+///
+/// @return     Returns `true` if the definition is compiled, otherwise `false`,
+///             in which case the policy should be evaluated by Lua.
+///
+bool Policy::compile(const std::string &p_def) {
+
+  std::string s;
+  std::remove_copy_if(p_def.begin(), p_def.end(), std::back_inserter(s),
+                      [](unsigned char c) { return std::isspace(c); });
+
+  if (s.empty()) {
+    return false;
+  }
+
+  auto variable = [&](const std::string &name) -> std::optional<PolicyVariable> {
+    if (auto it = native_variables.find(name); it != native_variables.end()) {
+      return it->second;
+    }
+    return std::nullopt;
+  };
+
+  auto is_meta = [&](const std::string &name) {
+    return std::find(meta_variables.begin(), meta_variables.end(), name) !=
+           meta_variables.end();
+  };
+
+  def = p_def;
+
+  // Unary functions, e.g., `min(pvalue)`, or `random`
+  auto f_name = s.substr(0, s.find('('));
+
+  if (f_name == "random") {
+    type = PolicyType::Random;
+    def = "random";
+  } else if (f_name == "first") {
+    type = PolicyType::First;
+    comparator = {PolicyVariable::Id};
+  } else if (f_name == "last") {
+    type = PolicyType::Last;
+    comparator = {PolicyVariable::Id};
+  } else if (f_name == "all") {
+    type = PolicyType::All;
+  } else if ((f_name == "min" or f_name == "max") and s.back() == ')') {
+    auto var = variable(s.substr(4, s.size() - 5));
+    if (!var) {
+      return false;
+    }
+    type = f_name == "min" ? PolicyType::Min : PolicyType::Max;
+    comparator = {*var};
+  }
+
+  // Meta variables, and their negations
+  else if (is_meta(s) or (s[0] == '!' and is_meta(s.substr(1)))) {
+    bool negated = s[0] == '!';
+    type = PolicyType::Comp;
+    predicate = {*variable(negated ? s.substr(1) : s), PolicyOperator::Equal,
+                 negated ? 0. : 1.};
+  }
+
+  // Comparisons, the order of binary_operators guarantees that `>=` and `<=`
+  // are being matched before `>` and `<`.
+  else {
+    auto op = std::find_if(
+        binary_operators.begin(), binary_operators.end(),
+        [&](auto &o) { return s.find(o) != std::string::npos; });
+    if (op == binary_operators.end()) {
+      return false;
+    }
+
+    auto op_start = s.find(*op);
+    auto var = variable(s.substr(0, op_start));
+    auto rhs = s.substr(op_start + op->size());
+    if (!var or rhs.empty()) {
+      return false;
+    }
+
+    double value{0};
+    if (rhs == "true" or rhs == "false") {
+      value = rhs == "true";
+    } else {
+      char *rhs_end{nullptr};
+      value = std::strtod(rhs.c_str(), &rhs_end);
+      if (rhs_end != rhs.c_str() + rhs.size()) {
+        return false;
+      }
+    }
+
+    type = PolicyType::Comp;
+    predicate = {*var, native_operators[*op], value};
+  }
+
+  is_native = true;
+  return true;
+}
+
 ///
 /// This applies the current policy on a range of values, and returns a subset
 /// of the range if it finds anything. If not, it will return an empty optional.
@@ -220,7 +334,8 @@ Policy::operator()(ForwardIt begin, ForwardIt end) {
 
   // This is probably the most used one!
   case PolicyType::Comp: {
-    auto pit = std::partition(begin, end, func);
+    auto pit = is_native ? std::partition(begin, end, predicate)
+                         : std::partition(begin, end, func);
     spdlog::trace("\n\t\tComp: {} \
                     \n\t\t\t{}",
                   def, fmt::join(begin, pit, "\n\t\t\t"));
@@ -238,7 +353,8 @@ Policy::operator()(ForwardIt begin, ForwardIt end) {
   } break;
 
   case PolicyType::Min: {
-    auto it = std::min_element(begin, end, func);
+    auto it = is_native ? std::min_element(begin, end, comparator)
+                        : std::min_element(begin, end, func);
     spdlog::trace("\n\t\tFunc: {} \
                       \n\t\t\t{}",
                   def, *it);
@@ -247,7 +363,8 @@ Policy::operator()(ForwardIt begin, ForwardIt end) {
   } break;
 
   case PolicyType::Max: {
-    auto it = std::max_element(begin, end, func);
+    auto it = is_native ? std::max_element(begin, end, comparator)
+                        : std::max_element(begin, end, func);
     spdlog::trace("\n\t\tFunc: {} \
                       \n\t\t\t{}",
                   def, *it);
@@ -259,7 +376,7 @@ Policy::operator()(ForwardIt begin, ForwardIt end) {
     /// Shuffling the array and setting the end pointer to the first time,
     /// this basically mimic the process of selecting a random element from
     /// the list.
-    Random::shuffle(begin, end);
+    std::shuffle(begin, end, rng(RandomStream::Policy));
     spdlog::trace("\n\t\tFunc: {} \
                       \n\t\t\t{}",
                   def, fmt::join(begin, end, "\n\t\t\t"));
@@ -404,9 +521,15 @@ PolicyChain::operator()(Experiment &experiment) {
 
   spdlog::trace("Looking for {}", *this);
 
+  // Policies are permuting a view of the treatment groups rather than the
+  // groups themselves, so, the Experiment stays sorted by id
+  thread_local std::vector<std::reference_wrapper<DependentVariable>> view;
+  view.assign(experiment.dvs_.begin() + experiment.setup.nd(),
+              experiment.dvs_.end());
+
   std::vector<Submission> selections{};
-  auto begin = experiment.dvs_.begin() + experiment.setup.nd();
-  auto end = experiment.dvs_.end();
+  auto begin = view.begin();
+  auto end = view.end();
 
   // Looping through PolicyChain(s)
   for (auto &policy : pchain) {
@@ -422,7 +545,7 @@ PolicyChain::operator()(Experiment &experiment) {
 
   if (begin != end) {
     for (auto it{begin}; it != end; ++it) {
-      selections.emplace_back(experiment, it->id_);
+      selections.emplace_back(experiment, it->get().id_);
     }
     spdlog::trace("✓ Found a bunch: {}", selections);
     return selections;
@@ -0,0 +1,78 @@
+//===-- RandomContext.cpp - Per-Simulation Random Number Streams ----------===//
+//
+// Part of the SAM Project
+// Created by Amir Masoud Abdol on 2020-11-02.
+//
+//===----------------------------------------------------------------------===//
+///
+/// @file
+/// This file contains the implementation of Xoshiro256 jump function, and the
+/// seeding procedure of the RandomContext.
+///
+//===----------------------------------------------------------------------===//
+
+#include "RandomContext.h"
+
+#include <atomic>
+
+#include "sam.h"
+
+using namespace sam;
+
+void Xoshiro256::jump() {
+  static constexpr std::array<std::uint64_t, 4> JUMP = {
+      0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL, 0xa9582618e03fc9aaULL,
+      0x39abdc4529b1661cULL};
+
+  std::array<std::uint64_t, 4> s{};
+  for (auto j : JUMP) {
+    for (int b{0}; b < 64; ++b) {
+      if (j & (std::uint64_t{1} << b)) {
+        for (int i{0}; i < 4; ++i) {
+          s[i] ^= s_[i];
+        }
+      }
+      (*this)();
+    }
+  }
+
+  s_ = s;
+}
+
+///
+/// The base engine is seeded by mixing the master seed and the simulation id,
+/// and each stream is then placed 2^128 steps after the previous one.
+///
+/// @note       Armadillo's generator of the calling thread is also reseeded,
+///             since some of the Armadillo's routines are still relying on it.
+///
+/// @note       Every call gets a new epoch, even if it's reseeding the same
+///             simulation, so that the distributions start over, see
+///             UnivariateDistribution.
+///
+/// @param[in]  master_seed  The master seed of the simulation
+/// @param[in]  simid        The simulation id
+///
+void RandomContext::seed(std::uint64_t master_seed, std::uint64_t simid) {
+  static std::atomic<std::uint64_t> last_epoch{0};
+
+  master_seed_ = master_seed;
+  simid_ = simid;
+  epoch_ = last_epoch.fetch_add(1, std::memory_order_relaxed) + 1;
+
+  std::uint64_t x = master_seed;
+  std::uint64_t key = Xoshiro256::splitmix64(x) ^ simid;
+  Xoshiro256 base(Xoshiro256::splitmix64(key));
+
+  for (auto &stream : streams_) {
+    stream = base;
+    base.jump();
+  }
+
+  arma::arma_rng::set_seed(static_cast<arma::arma_rng::seed_type>(base()));
+}
+
+RandomContext &RandomContext::local() {
+  thread_local RandomContext context;
+  return context;
+}
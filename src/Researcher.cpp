@@ -33,6 +33,11 @@ ResearcherBuilder Researcher::create(std::string name) {
 /// set will be ignored, and researcher continues with the next set, if
 /// available.
 ///
+/// Every hacking group is applied on a fresh state of the Experiment. Instead of
+/// copying the entire Experiment, hacks are applied in place, and the
+/// Experiment is restored to its snapshot, by a ScopedRestore, before moving to
+/// the next group, and before leaving.
+///
 /// @return     Returns `true` if any of the decision steps passes, it returns 
 ///             `false` indicating that none of the selection → decisions were 
 ///             successful.
@@ -40,10 +45,14 @@ std::optional<SubmissionPool>
 Researcher::hackTheResearch() {
 
   spdlog::debug("Initiate the Hacking Procedure...");
+
+  const auto original_experiment = experiment->snapshot();
   
   for (auto &hacking_group : hacking_workflow) {
 
-    Experiment copy_of_experiment = *experiment;
+    Experiment &hacked_experiment = *experiment;
+    const Experiment::ScopedRestore restore_guard{hacked_experiment,
+                                                  original_experiment};
 
     // It indicates whether or not the hacking is successful, if so, we skip the
     // remaining of the methods
@@ -78,9 +87,9 @@ Researcher::hackTheResearch() {
                     spdlog::trace("→ Starting a new HackingSet");
 
                     // Applying the hack
-                    (*hacking_strategy)(&copy_of_experiment);
+                    (*hacking_strategy)(&hacked_experiment);
 
-                    copy_of_experiment.setHackedStatus(true);
+                    hacked_experiment.setHackedStatus(true);
                   }
                 },
                 [&](PolicyChainSet &selection_policies) {
@@ -90,7 +99,7 @@ Researcher::hackTheResearch() {
                   // stashing, it'll select and stash some of the outcomes to
                   // into stashed_submissions
                   hacked_subs = research_strategy->selectOutcomeFromExperiment(
-                      &copy_of_experiment, selection_policies);
+                      &hacked_experiment, selection_policies);
                 },
                 [&](PolicyChain &decision_policy) {
                   // Performing a Decision
@@ -147,7 +156,8 @@ void Researcher::randomizeHackingStrategies() {
     hacking_workflow.clear();
 
     // Shuffling the original list
-    Random::shuffle(original_workflow.begin(), original_workflow.end());
+    std::shuffle(original_workflow.begin(), original_workflow.end(),
+                 rng(RandomStream::Researcher));
     hacking_workflow = original_workflow;
 
     // Sorting based on the given selection criteria
@@ -201,7 +211,8 @@ void Researcher::submitTheResearch(
 
     // Decides whether the researcher follows through with the submission or
     // bails out and put her research into the drawer!
-    if (Random::get<bool>(static_cast<float>(submission_probability()))) {
+    if (std::bernoulli_distribution{static_cast<float>(
+            submission_probability())}(rng(RandomStream::Researcher))) {
       journal->review(candidate_submissions.value());
     }
   }
@@ -218,8 +229,8 @@ void Researcher::submitTheResearch(
 /// _only if_ it contains a distribution.
 ///
 bool Researcher::isHacker() {
-  return Random::get<bool>(
-      static_cast<float>(probability_of_being_a_hacker()));
+  return std::bernoulli_distribution{static_cast<float>(
+      probability_of_being_a_hacker())}(rng(RandomStream::Researcher));
 }
 
 ///
@@ -229,19 +240,22 @@ bool Researcher::isHacker() {
 /// value of #probability_of_committing_a_hack.
 /// 
 bool Researcher::isCommittingToTheHack(HackingStrategy *hs) {
+  auto &gen = rng(RandomStream::Researcher);
+  auto bernoulli = [&](double p) { return std::bernoulli_distribution{p}(gen); };
+
   return std::visit(
-      overload{[&](float &p) { return Random::get<bool>(p); },
+      overload{[&](float &p) { return bernoulli(p); },
                [&](std::string &s) {
                  if (s == "prevalence") {
-                   return Random::get<bool>(hs->prevalence());
+                   return bernoulli(hs->prevalence());
                  }
-                 return Random::get<bool>(hs->defensibility());
+                 return bernoulli(hs->defensibility());
                },
                [&](UnivariateDistribution &dist) {
-                 return Random::get<bool>(Random::get(dist));
+                 return bernoulli(dist(gen));
                },
                [&](std::unique_ptr<HackingProbabilityStrategy> &hps) {
-                 return Random::get<bool>(hps->estimate(experiment.get()));
+                 return bernoulli(hps->estimate(experiment.get()));
                }},
       probability_of_committing_a_hack);
 }
@@ -408,7 +422,7 @@ void Researcher::reorderHackingStrategies(HackingWorkflow &hw,
     try {
 
       if (priority == "random") {
-        Random::shuffle(hw);
+        std::shuffle(hw.begin(), hw.end(), rng(RandomStream::Researcher));
       } else if (priority == "asc(prevalence)") {
         std::sort(group.begin(), group.end(), [&](auto &h1, auto &h2) {
           return std::get<0>(h1[0])->prevalence() <
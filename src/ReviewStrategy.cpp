@@ -95,8 +95,9 @@ bool PolicyBasedSelection::review(const std::vector<Submission> &subs) {
   /// @todo I don't really like the const_cast here, maybe I need to find a way
   /// to remove it!
   auto check = selection_policy(const_cast<std::vector<Submission> &>(subs));
-  return Random::get<bool>(params.acceptance_rate) and (check or
-      Random::get<bool>(1 - params.pub_bias_rate));
+  auto &gen = rng(RandomStream::Review);
+  return std::bernoulli_distribution{params.acceptance_rate}(gen) and
+         (check or std::bernoulli_distribution{1 - params.pub_bias_rate}(gen));
 }
 
 ///
@@ -115,7 +116,8 @@ bool SignificantSelection::review(const std::vector<Submission> &subs) {
   return std::any_of(
              subs.begin(), subs.end(),
              [&](auto &s) -> bool { return s.dv_.pvalue_ < params.alpha; }) or
-         Random::get<bool>(1 - params.pub_bias_rate);
+         std::bernoulli_distribution{1 - params.pub_bias_rate}(
+             rng(RandomStream::Review));
 }
 
 ///
@@ -126,5 +128,6 @@ bool SignificantSelection::review(const std::vector<Submission> &subs) {
 /// @return     a boolean indicating whether the Submission is accepted.
 ///
 bool RandomSelection::review(const std::vector<Submission> &subs) {
-  return Random::get<bool>(params.acceptance_rate);
+  return std::bernoulli_distribution{params.acceptance_rate}(
+      rng(RandomStream::Review));
 }
@@ -17,6 +17,9 @@ namespace sam {
 Submission::Submission(Experiment &e, const int &index) {
   
   dv_ = e[index];
+  if (!is_retaining_measurements) {
+    dv_.releaseMeasurements();
+  }
  
   simid = e.simid;
   exprid = e.exprid;
@@ -25,8 +28,10 @@ Submission::Submission(Experiment &e, const int &index) {
 
 Submission::Submission(int sim_id, int expr_id, int rep_id, int pub_id, DependentVariable dv)
   : simid{sim_id}, exprid{expr_id}, repid{rep_id}, pubid{pub_id},
-      dv_{dv} {
-
+      dv_{std::move(dv)} {
+  if (!is_retaining_measurements) {
+    dv_.releaseMeasurements();
+  }
 }
 
 std::vector<std::string> Submission::Columns() {
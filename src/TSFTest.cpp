@@ -11,19 +11,72 @@ using boost::math::fisher_f;
 
 void FTest::run(Experiment *experiment) {
 
-  static ResultType res;
+  thread_local arma::Row<float> Sd1, Sn1, Sd2, Sn2;
+  thread_local BatchResultType res;
+
+  const auto &table = experiment->statistics();
+  const auto &pairs = experiment->stalePairs();
+  const auto n = static_cast<arma::uword>(pairs.size());
+  for (auto *row : {&Sd1, &Sn1, &Sd2, &Sn2}) {
+    row->set_size(n);
+  }
 
   // The first group is always the control group
-  for (int i{experiment->setup.nd()}, d{0}; i < experiment->setup.ng();
-       ++i, ++d %= experiment->setup.nd()) {
+  for (arma::uword k{0}; k < n; ++k) {
+    const int i = pairs[k];
+    const int d = i % experiment->setup.nd();
+    Sd1[k] = table.stddev[d];
+    Sn1[k] = table.nobs[d];
+    Sd2[k] = table.stddev[i];
+    Sn2[k] = table.nobs[i];
+  }
+
+  f_test_batch(Sd1, Sn1, Sd2, Sn2, params.alpha, res);
 
-    res =
-        f_test((*experiment)[d].stddev_, (*experiment)[d].nobs_,
-               (*experiment)[i].stddev_, (*experiment)[i].nobs_, params.alpha);
+  scatter(experiment, res);
+}
+
+///
+/// Batched version of f_test(). The statistics are computed element-wise, and
+/// the distribution and its critical values are only recomputed when the
+/// degrees of freedom of a pair differ from the previous one.
+///
+/// @note       `res.df` is set to the first degrees of freedom, i.e., `Sn1 - 1`.
+///
+void FTest::f_test_batch(const arma::Row<float> &Sd1,
+                         const arma::Row<float> &Sn1,
+                         const arma::Row<float> &Sd2,
+                         const arma::Row<float> &Sn2, float alpha,
+                         BatchResultType &res) {
+
+  const auto n = Sd1.n_elem;
+  res.set_size(n);
 
-    (*experiment)[i].stats_ = res.fstat;
-    (*experiment)[i].pvalue_ = res.pvalue;
-    (*experiment)[i].sig_ = res.sig;
+  // F-statistic:
+  res.stats = Sd1 / Sd2;
+  res.df = Sn1 - 1;
+
+  float df1{-1}, df2{-1};
+  fisher_f dist(1, 1);
+  double ucv{0}, ucv2{0}, lcv{0}, lcv2{0};
+
+  for (arma::uword k{0}; k < n; ++k) {
+
+    if (Sn1[k] - 1 != df1 || Sn2[k] - 1 != df2) {
+      df1 = Sn1[k] - 1;
+      df2 = Sn2[k] - 1;
+      dist = fisher_f(df1, df2);
+
+      ucv = quantile(complement(dist, alpha));
+      ucv2 = quantile(complement(dist, alpha / 2));
+      lcv = quantile(dist, alpha);
+      lcv2 = quantile(dist, alpha / 2);
+    }
+
+    const double f_stats = res.stats[k];
+    res.pvalue[k] = static_cast<float>(cdf(dist, f_stats));
+    res.sig[k] = (ucv2 < f_stats) || (lcv2 > f_stats) || (lcv > f_stats) ||
+                 (ucv < f_stats);
   }
 }
 
@@ -4,36 +4,112 @@
 
 #include "TestStrategy.h"
 
-#include <boost/math/distributions/students_t.hpp>
+#include "PValueService.h"
 
 using namespace sam;
-using boost::math::students_t;
 
+///
+/// Scores all (control, treatment) pairs of the experiment in one go. The
+/// descriptive statistics are first gathered into contiguous rows, and then
+/// passed to t_test_batch().
+///
 void TTest::run(Experiment *experiment) {
 
-  static ResultType res{};
+  thread_local arma::Row<float> Sm1, Sd1, Sn1, Sm2, Sd2, Sn2;
+  thread_local BatchResultType res{};
+
+  const auto &table = experiment->statistics();
+  const auto &pairs = experiment->stalePairs();
+  const auto n = static_cast<arma::uword>(pairs.size());
+  for (auto *row : {&Sm1, &Sd1, &Sn1, &Sm2, &Sd2, &Sn2}) {
+    row->set_size(n);
+  }
 
   // The first group is always the control group
-  for (int i{experiment->setup.nd()}, d{0}; i < experiment->setup.ng();
-       ++i, ++d %= experiment->setup.nd()) {
-
-    if (params.var_equal) {
-      res = two_samples_t_test_equal_sd((*experiment)[d].mean_, (*experiment)[d].stddev_,
-                                        (*experiment)[d].nobs_, (*experiment)[i].mean_,
-                                        (*experiment)[i].stddev_, (*experiment)[i].nobs_,
-                                        params.alpha, params.alternative);
-    } else {
-      res = two_samples_t_test_unequal_sd((*experiment)[d].mean_, (*experiment)[d].stddev_,
-                                          (*experiment)[d].nobs_, (*experiment)[i].mean_,
-                                          (*experiment)[i].stddev_, (*experiment)[i].nobs_,
-                                          params.alpha,
-                                          params.alternative);
-    }
+  for (arma::uword k{0}; k < n; ++k) {
+    const int i = pairs[k];
+    const int d = i % experiment->setup.nd();
+    Sm1[k] = table.mean[d];
+    Sd1[k] = table.stddev[d];
+    Sn1[k] = table.nobs[d];
+    Sm2[k] = table.mean[i];
+    Sd2[k] = table.stddev[i];
+    Sn2[k] = table.nobs[i];
+  }
+
+  t_test_batch(Sm1, Sd1, Sn1, Sm2, Sd2, Sn2, params.alpha, params.alternative,
+               params.var_equal, res);
+
+  scatter(experiment, res);
+}
+
+///
+/// Batched version of two_samples_t_test_equal_sd() and
+/// two_samples_t_test_unequal_sd(). The statistics and degrees of freedom of
+/// all pairs are computed with element-wise, vectorizable, kernels, and
+/// p-values are then evaluated by two_samples_t_pvalues().
+///
+/// The kernels run in double, and only their results are rounded to float. The
+/// per-pair functions keep some of their intermediate values in float; so, the
+/// two agree up to the float rounding of those values, and not bit by bit.
+///
+/// @param      Sm1, Sd1, Sn1  Means, standard deviations, and sizes of the
+///                            first samples
+/// @param      Sm2, Sd2, Sn2  Means, standard deviations, and sizes of the
+///                            second samples
+/// @param      alpha          Significance Level.
+/// @param      alternative    The side of the test
+/// @param      equal_var      Whether to use the pooled variance
+/// @param      res            The output, one element per pair
+///
+void TTest::t_test_batch(const arma::Row<float> &Sm1,
+                         const arma::Row<float> &Sd1,
+                         const arma::Row<float> &Sn1,
+                         const arma::Row<float> &Sm2,
+                         const arma::Row<float> &Sd2,
+                         const arma::Row<float> &Sn2, float alpha,
+                         TestStrategy::TestAlternative alternative,
+                         bool equal_var, BatchResultType &res) {
+
+  using arma::conv_to;
+
+  const auto m1 = conv_to<arma::Row<double>>::from(Sm1);
+  const auto d1 = conv_to<arma::Row<double>>::from(Sd1);
+  const auto n1 = conv_to<arma::Row<double>>::from(Sn1);
+  const auto m2 = conv_to<arma::Row<double>>::from(Sm2);
+  const auto d2 = conv_to<arma::Row<double>>::from(Sd2);
+  const auto n2 = conv_to<arma::Row<double>>::from(Sn2);
+
+  if (equal_var) {
+    // Degrees of freedom:
+    const arma::Row<double> df = n1 + n2 - 2;
+
+    // Pooled variance and hence standard deviation:
+    arma::Row<double> sp = arma::sqrt(
+        ((n1 - 1) % arma::square(d1) + (n2 - 1) % arma::square(d2)) / df);
 
-    (*experiment)[i].stats_ = res.tstat;
-    (*experiment)[i].pvalue_ = res.pvalue;
-    (*experiment)[i].sig_ = res.sig;
+    // See two_samples_t_test_equal_sd()
+    sp.replace(0., std::numeric_limits<float>::epsilon());
+
+    // t-statistic:
+    res.df = conv_to<arma::Row<float>>::from(df);
+    res.stats = conv_to<arma::Row<float>>::from(
+        (m1 - m2) / (sp % arma::sqrt(1. / n1 + 1. / n2)));
+  } else {
+    const arma::Row<double> v1 = arma::square(d1) / n1;
+    const arma::Row<double> v2 = arma::square(d2) / n2;
+
+    // Degrees of freedom:
+    res.df = conv_to<arma::Row<float>>::from(
+        arma::square(v1 + v2) /
+        (arma::square(v1) / (n1 - 1) + arma::square(v2) / (n2 - 1)));
+
+    // t-statistic:
+    res.stats =
+        conv_to<arma::Row<float>>::from((m1 - m2) / arma::sqrt(v1 + v2));
   }
+
+  two_samples_t_pvalues(res, alpha, alternative);
 }
 
 TTest::ResultType TTest::t_test(const arma::Row<float> &dt1,
@@ -64,15 +140,14 @@ TTest::ResultType TTest::t_test(float Sm1, float Sd1, float Sn1, float Sm2,
 std::pair<float, bool>
 TTest::compute_pvalue(float t_stat, float df, float alpha, TestStrategy::TestAlternative alternative) {
   
-  using boost::math::students_t;
-  students_t dist(df);
+  auto &service = PValueService::local();
   
   double p{0};
   bool sig{false};
   
   if (alternative == TestStrategy::TestAlternative::TwoSided) {
     // Mean != M
-    p = 2. * cdf(complement(dist, fabs(t_stat)));
+    p = 2. * service.upperTail(fabs(t_stat), df);
     if (p < alpha) { // Alternative "NOT REJECTED"
       sig = true;
     } else { // Alternative "REJECTED"
@@ -82,7 +157,7 @@ TTest::compute_pvalue(float t_stat, float df, float alpha, TestStrategy::TestAlt
   
   if (alternative == TestStrategy::TestAlternative::Greater) {
     // Mean  > M
-    p = cdf(dist, t_stat);
+    p = service.cdf(t_stat, df);
     if (p > alpha) { // Alternative "NOT REJECTED"
       sig = true;
     } else { // Alternative "REJECTED"
@@ -92,7 +167,7 @@ TTest::compute_pvalue(float t_stat, float df, float alpha, TestStrategy::TestAlt
   
   if (alternative == TestStrategy::TestAlternative::Less) {
     // Mean  < M
-    p = cdf(complement(dist, t_stat));
+    p = service.upperTail(t_stat, df);
     if (p > alpha) { // Alternative "NOT REJECTED"
       sig = true;
     } else { // Alternative "REJECTED"
@@ -136,9 +211,9 @@ TTest::single_sample_t_test(float M, float Sm, float Sd, unsigned Sn,
   float t_stat = diff * sqrt(float(Sn)) / Sd;
 
   //
-  // Finally define our distribution, and get the probability:
+  // Finally get the probability from the p-value service:
   //
-  students_t dist(df);
+  auto &service = PValueService::local();
   float p = 0;
 
   //
@@ -147,7 +222,7 @@ TTest::single_sample_t_test(float M, float Sm, float Sd, unsigned Sn,
 
   if (alternative == TestStrategy::TestAlternative::TwoSided) {
     // Mean != M
-    p = 2 * cdf(complement(dist, fabs(t_stat)));
+    p = 2 * service.upperTail(fabs(t_stat), df);
     if (p < alpha) // Alternative "NOT REJECTED"
       sig = true;
     else // Alternative "REJECTED"
@@ -156,7 +231,7 @@ TTest::single_sample_t_test(float M, float Sm, float Sd, unsigned Sn,
 
   if (alternative == TestStrategy::TestAlternative::Greater) {
     // Mean  > M
-    p = cdf(dist, t_stat);
+    p = service.cdf(t_stat, df);
     if (p > alpha) // Alternative "NOT REJECTED"
       sig = true;
     else // Alternative "REJECTED"
@@ -165,7 +240,7 @@ TTest::single_sample_t_test(float M, float Sm, float Sd, unsigned Sn,
 
   if (alternative == TestStrategy::TestAlternative::Less) {
     // Mean  < M
-    p = cdf(complement(dist, t_stat));
+    p = service.upperTail(t_stat, df);
     if (p > alpha) // Alternative "NOT REJECTED"
       sig = true;
     else // Alternative "REJECTED"
@@ -216,9 +291,9 @@ TTest::ResultType TTest::two_samples_t_test_equal_sd(
   float t_stat = (Sm1 - Sm2) / (sp * sqrt(1.0 / Sn1 + 1.0 / Sn2));
 
   //
-  // Define our distribution, and get the probability:
+  // Get the probability from the p-value service:
   //
-  students_t dist(df);
+  auto &service = PValueService::local();
   float p = 0;
 
   //
@@ -227,7 +302,7 @@ TTest::ResultType TTest::two_samples_t_test_equal_sd(
 
   if (alternative == TestStrategy::TestAlternative::TwoSided) {
     // Sample 1 Mean != Sample 2 Mean
-    p = 2 * cdf(complement(dist, fabs(t_stat)));
+    p = 2 * service.upperTail(fabs(t_stat), df);
     if (p < alpha) // Alternative "NOT REJECTED"
       sig = true;
     else // Alternative "REJECTED"
@@ -236,7 +311,7 @@ TTest::ResultType TTest::two_samples_t_test_equal_sd(
 
   if (alternative == TestStrategy::TestAlternative::Greater) {
     // Sample 1 Mean <  Sample 2 Mean
-    p = cdf(dist, t_stat);
+    p = service.cdf(t_stat, df);
     if (p < alpha) // Alternative "NOT REJECTED"
       sig = true;
     else // Alternative "REJECTED"
@@ -246,7 +321,7 @@ TTest::ResultType TTest::two_samples_t_test_equal_sd(
   if (alternative == TestStrategy::TestAlternative::Less) {
 
     // Sample 1 Mean >  Sample 2 Mean
-    p = cdf(complement(dist, t_stat));
+    p = service.upperTail(t_stat, df);
     if (p < alpha) // Alternative "NOT REJECTED"
       sig = true;
     else
@@ -294,9 +369,9 @@ TTest::ResultType TTest::two_samples_t_test_unequal_sd(
   float t_stat = (Sm1 - Sm2) / sqrt(Sd1 * Sd1 / Sn1 + Sd2 * Sd2 / Sn2);
 
   //
-  // Define our distribution, and get the probability:
+  // Get the probability from the p-value service:
   //
-  students_t dist(df);
+  auto &service = PValueService::local();
   float p = 0;
 
   //
@@ -305,7 +380,7 @@ TTest::ResultType TTest::two_samples_t_test_unequal_sd(
 
   if (alternative == TestStrategy::TestAlternative::TwoSided) {
     // Sample 1 Mean != Sample 2 Mean
-    p = 2 * cdf(complement(dist, fabs(t_stat)));
+    p = 2 * service.upperTail(fabs(t_stat), df);
     if (p < alpha) // Alternative "NOT REJECTED"
       sig = true;
     else // Alternative "REJECTED"
@@ -314,7 +389,7 @@ TTest::ResultType TTest::two_samples_t_test_unequal_sd(
 
   if (alternative == TestStrategy::TestAlternative::Greater) {
     // Sample 1 Mean <  Sample 2 Mean
-    p = cdf(dist, t_stat);
+    p = service.cdf(t_stat, df);
     if (p < alpha) // Alternative "NOT REJECTED"
       sig = true;
     else // Alternative "REJECTED"
@@ -323,7 +398,7 @@ TTest::ResultType TTest::two_samples_t_test_unequal_sd(
 
   if (alternative == TestStrategy::TestAlternative::Less) {
     // Sample 1 Mean >  Sample 2 Mean
-    p = cdf(complement(dist, t_stat));
+    p = service.upperTail(t_stat, df);
     if (p < alpha) // Alternative "NOT REJECTED"
       sig = true;
     else
@@ -10,13 +10,13 @@ void WilcoxonTest::run(Experiment *experiment) {
 
   // The first group is always the control group
 
-  static ResultType res;
+  thread_local ResultType res;
 
-  for (int i{experiment->setup.nd()}, d{0}; i < experiment->setup.ng();
-       ++i, ++d %= experiment->setup.nd()) {
+  for (int i : experiment->stalePairs()) {
+    const int d = i % experiment->setup.nd();
 
-    res = wilcoxon_test((*experiment)[d].measurements(),
-                        (*experiment)[i].measurements(),
+    res = wilcoxon_test(std::as_const(*experiment)[d].measurements(),
+                        std::as_const(*experiment)[i].measurements(),
                         params.use_continuity, params.alpha,
                         params.alternative);
 
@@ -4,38 +4,86 @@
 
 #include "TestStrategy.h"
 
-#include <boost/math/distributions/students_t.hpp>
+#include "PValueService.h"
 
 using namespace sam;
-using boost::math::students_t;
 
+///
+/// In the two samples case, the trimmed statistics of each group are computed
+/// only once, see yuen_summary(), and all (control, treatment) pairs are then
+/// scored together by yuen_t_test_batch(). This avoids sorting the control
+/// groups once per treatment group. Only the groups of the stale pairs are
+/// being summarized.
+///
 void YuenTest::run(Experiment *experiment) {
 
   // The first group is always the control group
 
-  static YuenTest::ResultType res;
+  if (params.paired) {
 
-  for (int i{experiment->setup.nd()}, d{0}; i < experiment->setup.ng();
-       ++i, ++d %= experiment->setup.nd()) {
+    thread_local YuenTest::ResultType res;
 
-    if (params.paired) {
-      res = yuen_t_test_paired((*experiment)[d].measurements(),
-                               (*experiment)[i].measurements(),
+    for (int i : experiment->stalePairs()) {
+      const int d = i % experiment->setup.nd();
+
+      res = yuen_t_test_paired(std::as_const(*experiment)[d].measurements(),
+                               std::as_const(*experiment)[i].measurements(),
                                params.alpha,
                                params.alternative,
                                params.trim,
                                0);
-    }else{
-      res = yuen_t_test_two_samples((*experiment)[d].measurements(),
-                                    (*experiment)[i].measurements(),
-                                    params.alpha,
-                                    params.alternative, params.trim, 0);
+
+      (*experiment)[i].stats_ = res.tstat;
+      (*experiment)[i].pvalue_ = res.pvalue;
+      (*experiment)[i].sig_ = res.sig;
     }
 
-    (*experiment)[i].stats_ = res.tstat;
-    (*experiment)[i].pvalue_ = res.pvalue;
-    (*experiment)[i].sig_ = res.sig;
+    return;
+  }
+
+  thread_local arma::Row<float> Tm, D, H;
+  thread_local arma::Row<float> Tm1, D1, H1, Tm2, D2, H2;
+  thread_local BatchResultType res;
+  thread_local std::vector<bool> is_summarized;
+
+  const auto &pairs = experiment->stalePairs();
+  const auto ng = static_cast<arma::uword>(experiment->setup.ng());
+  const auto n = static_cast<arma::uword>(pairs.size());
+
+  for (auto *row : {&Tm, &D, &H}) {
+    row->set_size(ng);
   }
+  for (auto *row : {&Tm1, &D1, &H1, &Tm2, &D2, &H2}) {
+    row->set_size(n);
+  }
+
+  is_summarized.assign(ng, false);
+  auto summarize = [&](int g) {
+    if (!is_summarized[g]) {
+      std::tie(Tm[g], D[g], H[g]) = yuen_summary(
+          std::as_const(*experiment)[g].measurements(), params.trim);
+      is_summarized[g] = true;
+    }
+  };
+
+  for (arma::uword k{0}; k < n; ++k) {
+    const int i = pairs[k];
+    const int d = i % experiment->setup.nd();
+    summarize(d);
+    summarize(i);
+
+    Tm1[k] = Tm[d];
+    D1[k] = D[d];
+    H1[k] = H[d];
+    Tm2[k] = Tm[i];
+    D2[k] = D[i];
+    H2[k] = H[i];
+  }
+
+  yuen_t_test_batch(Tm1, D1, H1, Tm2, D2, H2, params.alpha, params.alternative,
+                    0, res);
+
+  scatter(experiment, res);
 }
 
 YuenTest::ResultType YuenTest::yuen_t_test_one_sample(
@@ -62,12 +110,12 @@ YuenTest::ResultType YuenTest::yuen_t_test_one_sample(
 
   float t_stat = (dif - mu) / se;
 
-  students_t dist(df);
+  auto &service = PValueService::local();
   float p = 0;
 
   if (alternative == TestStrategy::TestAlternative::TwoSided) {
     // Mean != M
-    p = 2 * cdf(complement(dist, fabs(t_stat)));
+    p = 2 * service.upperTail(fabs(t_stat), df);
     if (p < alpha) // Alternative "NOT REJECTED"
       sig = true;
     else // Alternative "REJECTED"
@@ -76,7 +124,7 @@ YuenTest::ResultType YuenTest::yuen_t_test_one_sample(
 
   if (alternative == TestStrategy::TestAlternative::Greater) {
     // Mean  > M
-    p = cdf(complement(dist, t_stat));
+    p = service.upperTail(t_stat, df);
     if (p > alpha) // Alternative "NOT REJECTED"
       sig = true;
     else // Alternative "REJECTED"
@@ -85,7 +133,7 @@ YuenTest::ResultType YuenTest::yuen_t_test_one_sample(
 
   if (alternative == TestStrategy::TestAlternative::Less) {
     // Mean  < M
-    p = cdf(dist, t_stat);
+    p = service.cdf(t_stat, df);
     if (p > alpha) // Alternative "NOT REJECTED"
       sig = true;
     else // Alternative "REJECTED"
@@ -123,12 +171,12 @@ YuenTest::yuen_t_test_paired(const arma::Row<float> &x,
 
   float t_stat = (dif - mu) / se;
 
-  students_t dist(df);
+  auto &service = PValueService::local();
   float p = 0;
 
   if (alternative == TestStrategy::TestAlternative::TwoSided) {
     // Mean != M
-    p = 2 * cdf(complement(dist, fabs(t_stat)));
+    p = 2 * service.upperTail(fabs(t_stat), df);
     if (p < alpha) // Alternative "NOT REJECTED"
       sig = true;
     else // Alternative "REJECTED"
@@ -137,7 +185,7 @@ YuenTest::yuen_t_test_paired(const arma::Row<float> &x,
 
   if (alternative == TestStrategy::TestAlternative::Greater) {
     // Mean  > M
-    p = cdf(complement(dist, t_stat));
+    p = service.upperTail(t_stat, df);
     if (p > alpha) // Alternative "NOT REJECTED"
       sig = true;
     else // Alternative "REJECTED"
@@ -146,7 +194,7 @@ YuenTest::yuen_t_test_paired(const arma::Row<float> &x,
 
   if (alternative == TestStrategy::TestAlternative::Less) {
     // Mean  < M
-    p = cdf(dist, t_stat);
+    p = service.cdf(t_stat, df);
     if (p > alpha) // Alternative "NOT REJECTED"
       sig = true;
     else // Alternative "REJECTED"
@@ -190,12 +238,12 @@ YuenTest::ResultType YuenTest::yuen_t_test_two_samples(
 
   float t_stat = (dif - mu) / se;
 
-  students_t dist(df);
+  auto &service = PValueService::local();
   float p;
 
   if (alternative == TestStrategy::TestAlternative::TwoSided) {
     // Sample 1 Mean != Sample 2 Mean
-    p = 2 * cdf(complement(dist, fabs(t_stat)));
+    p = 2 * service.upperTail(fabs(t_stat), df);
     if (p < alpha) // Alternative "NOT REJECTED"
       sig = true;
     else // Alternative "REJECTED"
@@ -204,7 +252,7 @@ YuenTest::ResultType YuenTest::yuen_t_test_two_samples(
 
   if (alternative == TestStrategy::TestAlternative::Greater) {
     // Sample 1 Mean <  Sample 2 Mean
-    p = cdf(dist, t_stat);
+    p = service.cdf(t_stat, df);
     if (p < alpha) // Alternative "NOT REJECTED"
       sig = true;
     else // Alternative "REJECTED"
@@ -213,7 +261,7 @@ YuenTest::ResultType YuenTest::yuen_t_test_two_samples(
 
   if (alternative == TestStrategy::TestAlternative::Less) {
     // Sample 1 Mean >  Sample 2 Mean
-    p = cdf(complement(dist, t_stat));
+    p = service.upperTail(t_stat, df);
     if (p < alpha) // Alternative "NOT REJECTED"
       sig = true;
     else // Alternative "REJECTED"
@@ -222,3 +270,58 @@ YuenTest::ResultType YuenTest::yuen_t_test_two_samples(
 
   return {.tstat = t_stat, .df = df, .pvalue = p, .sig = sig};
 }
+
+///
+/// Computes the per-sample quantities of the two samples Yuen test, i.e., the
+/// trimmed mean, the squared standard error of the trimmed mean, and the
+/// effective sample size after trimming.
+///
+/// @return     A tuple of (trimmed mean, d, h)
+///
+std::tuple<float, float, float>
+YuenTest::yuen_summary(const arma::Row<float> &x, float trim) {
+
+  int h = x.n_elem - 2 * floor(trim * x.n_elem);
+
+  float d = (x.n_elem - 1.) * win_var(x, trim) / (h * (h - 1.));
+
+  if (!(isgreater(d, 0) or isless(d, 0))) {
+    // Samples are almost equal and elements are constant
+    d += std::numeric_limits<float>::epsilon();
+  }
+
+  return {trim_mean(x, trim), d, static_cast<float>(h)};
+}
+
+///
+/// Batched version of yuen_t_test_two_samples() working on the summaries
+/// provided by yuen_summary(). Like TTest::t_test_batch(), the kernels run in
+/// double, and only their results are rounded to float.
+///
+void YuenTest::yuen_t_test_batch(const arma::Row<float> &Tm1,
+                                 const arma::Row<float> &D1,
+                                 const arma::Row<float> &H1,
+                                 const arma::Row<float> &Tm2,
+                                 const arma::Row<float> &D2,
+                                 const arma::Row<float> &H2, float alpha,
+                                 const TestStrategy::TestAlternative alternative,
+                                 float mu, BatchResultType &res) {
+
+  using arma::conv_to;
+
+  const auto tm1 = conv_to<arma::Row<double>>::from(Tm1);
+  const auto d1 = conv_to<arma::Row<double>>::from(D1);
+  const auto h1 = conv_to<arma::Row<double>>::from(H1);
+  const auto tm2 = conv_to<arma::Row<double>>::from(Tm2);
+  const auto d2 = conv_to<arma::Row<double>>::from(D2);
+  const auto h2 = conv_to<arma::Row<double>>::from(H2);
+
+  res.df = conv_to<arma::Row<float>>::from(
+      arma::square(d1 + d2) /
+      (arma::square(d1) / (h1 - 1.) + arma::square(d2) / (h2 - 1.)));
+
+  res.stats = conv_to<arma::Row<float>>::from((tm1 - tm2 - mu) /
+                                              arma::sqrt(d1 + d2));
+
+  two_samples_t_pvalues(res, alpha, alternative);
+}
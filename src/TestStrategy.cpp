@@ -7,6 +7,7 @@
 #include <boost/math/distributions/normal.hpp>
 #include <boost/math/distributions/students_t.hpp>
 
+#include "PValueService.h"
 #include "TestStrategy.h"
 
 using namespace sam;
@@ -38,6 +39,17 @@ std::unique_ptr<TestStrategy> TestStrategy::build(json &test_strategy_config) {
   }
 }
 
+void TestStrategy::scatter(Experiment *experiment, const BatchResultType &res) {
+
+  const auto &pairs = experiment->stalePairs();
+  for (std::size_t k{0}; k < pairs.size(); ++k) {
+    const int i = pairs[k];
+    (*experiment)[i].stats_ = res.stats[k];
+    (*experiment)[i].pvalue_ = res.pvalue[k];
+    (*experiment)[i].sig_ = res.sig[k];
+  }
+}
+
 
 namespace sam {
 
@@ -99,9 +111,50 @@ float single_sample_find_df(float M, float Sm, float Sd, float alpha,
   return ceil(df) + 1;
 }
 
-
-
-
+///
+/// Computes the p-values and significances of a batch of two samples t
+/// statistics, using the same convention as
+/// TTest::two_samples_t_test_equal_sd().
+///
+/// Probabilities are provided by the PValueService, and a test is significant
+/// if its p-value is less than alpha.
+///
+/// @param      res          The batch, with its `stats` and `df` set
+/// @param      alpha        The significance level
+/// @param      alternative  The side of the test
+///
+void two_samples_t_pvalues(TestStrategy::BatchResultType &res, float alpha,
+                           TestStrategy::TestAlternative alternative) {
+
+  auto &service = PValueService::local();
+
+  const auto n = res.stats.n_elem;
+  res.pvalue.set_size(n);
+  res.sig.set_size(n);
+
+  for (arma::uword k{0}; k < n; ++k) {
+
+    const float t_stat = res.stats[k];
+    const float df = res.df[k];
+
+    switch (alternative) {
+      case TestStrategy::TestAlternative::TwoSided:
+        // Sample 1 Mean != Sample 2 Mean
+        res.pvalue[k] = 2 * service.upperTail(fabs(t_stat), df);
+        break;
+      case TestStrategy::TestAlternative::Greater:
+        // Sample 1 Mean <  Sample 2 Mean
+        res.pvalue[k] = service.cdf(t_stat, df);
+        break;
+      case TestStrategy::TestAlternative::Less:
+        // Sample 1 Mean >  Sample 2 Mean
+        res.pvalue[k] = service.upperTail(t_stat, df);
+        break;
+    }
+
+    res.sig[k] = res.pvalue[k] < alpha;
+  }
+}
 
 float win_var(const arma::Row<float> &x, const float trim) {
   return arma::var(win_val(x, trim));
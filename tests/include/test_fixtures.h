@@ -26,7 +26,7 @@
 using namespace arma;
 using namespace sam;
 using namespace std;
-using Random = effolkronium::random_static;
+using Random = effolkronium::random_thread_local;
 
 struct SampleResearch {
 
@@ -83,6 +83,122 @@ BOOST_AUTO_TEST_SUITE( working_with_dependent_variable )
     BOOST_TEST(dp.true_nobs_ == 100);
   }
 
+  BOOST_AUTO_TEST_CASE( running_stats_against_full_recompute ) {
+    
+    arma::Row<float> data(100);
+    data.randn();
+    
+    DependentVariable dp{data};
+    
+    dp.addNewMeasurements(arma::Row<float>{1.5, -2., 3.});
+    dp.removeMeasurements(arma::uvec{0, 2, 7, 99});
+    dp.addNewMeasurements(arma::randn<arma::Row<float>>(20));
+    
+    auto incremental = dp;
+    dp.recomputeStats();
+    
+    BOOST_TEST(incremental.nobs_ == 119);
+    BOOST_TEST(incremental.nobs_ == dp.nobs_);
+    BOOST_TEST(incremental.mean_ == dp.mean_, tt::tolerance(0.0001f));
+    BOOST_TEST(incremental.var_ == dp.var_, tt::tolerance(0.0001f));
+    BOOST_TEST(incremental.sei_ == dp.sei_, tt::tolerance(0.0001f));
+    
+    // Writing into the buffer invalidates the running stats
+    dp.measurements() += 1;
+    dp.updateStats();
+    BOOST_TEST(dp.mean_ == incremental.mean_ + 1, tt::tolerance(0.0001f));
+    BOOST_TEST(dp.var_ == incremental.var_, tt::tolerance(0.0001f));
+  }
+
+  BOOST_AUTO_TEST_CASE( viewing_prefixes ) {
+
+    arma::Row<float> data(100);
+    data.randn();
+
+    DependentVariable dp{data};
+    auto original = dp;
+
+    for (int n : {10, 25, 60, 150}) {
+      dp.viewPrefix(n);
+
+      const auto head = data.head(std::min(n, 100));
+      BOOST_TEST(dp.nobs_ == head.n_elem);
+      BOOST_TEST(dp.true_nobs_ == dp.nobs_);
+      BOOST_TEST(dp.mean_ == arma::mean(head), tt::tolerance(0.0001f));
+      BOOST_TEST(dp.var_ == arma::var(head), tt::tolerance(0.0001f));
+    }
+
+    // The view is borrowing the buffer
+    BOOST_TEST(dp.isViewingPrefix());
+    BOOST_TEST(dp.isSharingMeasurements());
+
+    dp.viewPrefix(30);
+    BOOST_TEST(dp.mean_ == arma::mean(data.head(30)), tt::tolerance(0.0001f));
+
+    // Writing materializes the view, and leaves the original intact
+    dp.addNewMeasurements(arma::Row<float>{1., 2.});
+    BOOST_TEST(!dp.isViewingPrefix());
+    BOOST_TEST(dp.nobs_ == 32);
+    BOOST_TEST(original.nobs_ == 100);
+    BOOST_TEST(arma::approx_equal(original.measurements(), data, "absdiff", 0));
+  }
+
+  BOOST_AUTO_TEST_CASE( recycling_buffers ) {
+
+    auto &arena = MeasurementArena::local();
+
+    arma::Row<float> data(100);
+    data.randn();
+
+    {
+      DependentVariable dp{data};
+      auto copy = dp;
+      copy.addNewMeasurements(arma::Row<float>{1., 2.});
+      BOOST_TEST(arma::approx_equal(dp.measurements(), data, "absdiff", 0));
+    }
+
+    // Both buffers are back in the arena
+    const auto n_cached = arena.nCachedBlocks();
+    BOOST_TEST(n_cached >= 2);
+
+    DependentVariable dp{data};
+    BOOST_TEST(arena.nCachedBlocks() == n_cached - 1);
+
+    // There is enough room for new observations
+    dp.addNewMeasurements(arma::randn<arma::Row<float>>(20));
+    BOOST_TEST(arena.nCachedBlocks() == n_cached - 1);
+
+    dp.removeMeasurements(arma::uvec{0, 5, 119});
+    BOOST_TEST(dp.nobs_ == 117);
+    BOOST_TEST(dp.measurements()(4) == data(6));
+  }
+
+  BOOST_AUTO_TEST_CASE( releasing_measurements ) {
+    
+    arma::Row<float> data(100);
+    data.randn();
+    
+    DependentVariable dp{data};
+    dp.removeMeasurements(arma::uvec{1, 5});
+    auto mean = dp.mean_;
+    auto var = dp.var_;
+    
+    dp.releaseMeasurements();
+    BOOST_TEST(std::as_const(dp).measurements().is_empty());
+    BOOST_TEST(dp.nobs_ == 98);
+    
+    dp.updateStats();
+    BOOST_TEST(dp.nobs_ == 98);
+    BOOST_TEST(dp.mean_ == mean);
+    BOOST_TEST(dp.var_ == var);
+
+    // Asking for the (empty) buffer doesn't invalidate the statistics
+    BOOST_TEST(dp.measurements().is_empty());
+    dp.updateStats();
+    BOOST_TEST(dp.nobs_ == 98);
+    BOOST_TEST(dp.mean_ == mean);
+  }
+
   BOOST_AUTO_TEST_CASE( indices_operator_test, * utf::expected_failures(1) ) {
     
     arma::Row<float> data(100);
@@ -176,6 +176,101 @@ BOOST_AUTO_TEST_CASE( calculation_methods ) {
   
 }
 
+
+BOOST_AUTO_TEST_CASE( snapshot_and_restore ) {
+  
+  Experiment expr{sample_experiment_setup["experiment_parameters"]};
+  expr.generateData();
+  expr.recalculateEverything();
+  
+  auto snap = expr.snapshot();
+  for (auto &dv : expr.dvs_) {
+    BOOST_TEST(dv.isSharingMeasurements());
+  }
+  
+  auto mean_2 = expr.dvs_[2].mean_;
+  expr.dvs_[2].removeMeasurements({1, 2, 3});
+  expr.setHackedStatus(true);
+  
+  // Only the modified dependent variable owns a new buffer
+  BOOST_TEST(not expr.dvs_[2].isSharingMeasurements());
+  BOOST_TEST(expr.dvs_[3].isSharingMeasurements());
+  BOOST_TEST(snap.dvs[2].nobs_ == 10);
+  
+  expr.restore(snap);
+  BOOST_TEST(expr.isHacked() == false);
+  BOOST_TEST(expr.dvs_[2].nobs_ == 10);
+  BOOST_TEST(expr.dvs_[2].measurements().n_elem == 10);
+  BOOST_TEST(expr.dvs_[2].mean_ == mean_2);
+}
+
+BOOST_AUTO_TEST_CASE( selective_recalculation ) {
+
+  Experiment expr{sample_experiment_setup["experiment_parameters"]};
+  expr.generateData();
+  expr.recalculateEverything();
+
+  const int nd = expr.setup.nd();
+  const int ng = expr.setup.ng();
+
+  auto mark_treatments = [&]() {
+    for (int i{nd}; i < ng; ++i) {
+      expr.dvs_[i].pvalue_ = -1;
+    }
+  };
+
+  // Nothing has changed, so, nothing is being re-tested
+  mark_treatments();
+  expr.recalculateEverything();
+  for (int i{nd}; i < ng; ++i) {
+    BOOST_TEST(expr.dvs_[i].pvalue_ == -1);
+  }
+
+  // A treatment group only invalidates itself
+  expr.dvs_[ng - 1].removeMeasurements({1, 2});
+  expr.recalculateEverything();
+  for (int i{nd}; i < ng; ++i) {
+    BOOST_TEST((expr.dvs_[i].pvalue_ == -1) == (i != ng - 1));
+  }
+
+  // A control group invalidates all of its treatment groups
+  mark_treatments();
+  expr.dvs_[0].removeMeasurements({1, 2});
+  expr.calculateStatistics();
+  expr.calculateTests();
+  for (int i{nd}; i < ng; ++i) {
+    BOOST_TEST((expr.dvs_[i].pvalue_ == -1) == (i % nd != 0));
+  }
+}
+
+BOOST_AUTO_TEST_CASE( statistics_table ) {
+
+  Experiment expr{sample_experiment_setup["experiment_parameters"]};
+  expr.generateData();
+  expr.recalculateEverything();
+
+  auto snap = expr.snapshot();
+
+  auto matches_groups = [&]() {
+    const auto &table = expr.statistics();
+    BOOST_TEST(table.mean.n_elem == expr.dvs_.size());
+    for (const auto &dv : expr.dvs_) {
+      BOOST_TEST(table.nobs[dv.id_] == dv.nobs_);
+      BOOST_TEST(table.mean[dv.id_] == dv.mean_);
+      BOOST_TEST(table.stddev[dv.id_] == dv.stddev_);
+    }
+  };
+
+  matches_groups();
+
+  expr.dvs_[2].removeMeasurements({1, 2, 3});
+  expr.recalculateEverything();
+  matches_groups();
+
+  expr.restore(snap);
+  matches_groups();
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 //	BOOST_AUTO_TEST_CASE( linear_data_strategy_testing_stats )
@@ -72,3 +72,134 @@ BOOST_FIXTURE_TEST_SUITE( meta_analysis_strategy, SampleResearch )
     }
 
 BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE( meta_analysis_methods )
+
+    BOOST_AUTO_TEST_CASE( eggers_test_against_dense_sandwich )
+    {
+        arma::Row<float> yi = {0.42, 0.15, 0.71, 0.33, -0.05, 0.58, 0.27, 0.64, 0.12, 0.49};
+        arma::Row<float> vi = {0.04, 0.09, 0.02, 0.06, 0.12, 0.03, 0.08, 0.05, 0.10, 0.07};
+        
+        auto res = EggersTestEstimator::EggersTest(yi, vi, 0.1);
+        
+        // Reference, i.e., the weighted regression with the full sandwich
+        // estimator using dense n x n matrices
+        arma::Col<double> y = arma::conv_to<arma::Col<double>>::from(yi.t());
+        arma::Col<double> w = 1. / arma::conv_to<arma::Col<double>>::from(vi.t());
+        arma::Mat<double> Z = arma::join_rows(arma::ones<arma::Col<double>>(yi.n_elem),
+                                              arma::sqrt(1. / w));
+        arma::Mat<double> W = arma::diagmat(w);
+        arma::Mat<double> A = arma::inv(Z.t() * W * Z);
+        arma::Col<double> beta = A * Z.t() * W * y;
+        arma::Col<double> e = y - Z * beta;
+        double sigma2 = arma::accu(w % arma::square(e)) / (yi.n_elem - 2);
+        arma::Mat<double> S = arma::diagmat(sigma2 / w);
+        arma::Mat<double> V = A * (Z.t() * W * S * W.t() * Z) * A;
+        
+        BOOST_CHECK_SMALL(res.slope - beta(1), 1e-4);
+        BOOST_CHECK_SMALL(res.se - std::sqrt(V(1, 1)), 1e-4);
+    }
+
+    BOOST_AUTO_TEST_CASE( kendall_correlation_test )
+    {
+        // cor.test(1:5, c(2, 1, 4, 3, 5), method = "kendall")
+        // T = 8, p-value = 0.2333, tau = 0.6
+        auto [tau, pval] = kendall_cor_test({1, 2, 3, 4, 5}, {2, 1, 4, 3, 5},
+                                            TestStrategy::TestAlternative::TwoSided);
+        
+        BOOST_CHECK_SMALL(tau - 0.6f, 1e-6f);
+        BOOST_CHECK_SMALL(pval - 0.2333f, 1e-4f);
+        
+        // Ties in both variables, i.e., tau_b
+        // cor(c(1, 2, 2, 3, 4), c(1, 1, 2, 3, 3), method = "kendall")
+        BOOST_CHECK_SMALL(kendallcor({1, 2, 2, 3, 4}, {1, 1, 2, 3, 3}) - 0.8249579f, 1e-6f);
+    }
+
+    BOOST_AUTO_TEST_CASE( trim_and_fill_estimators )
+    {
+        arma::Row<float> yi = {0.42, 0.55, 0.71, 0.63, 0.05, 0.58, 0.27, 0.84, 0.12, 0.49, 0.95, 0.33};
+        arma::Row<float> vi = {0.04, 0.09, 0.12, 0.06, 0.01, 0.08, 0.02, 0.15, 0.01, 0.07, 0.20, 0.03};
+        
+        TrimAndFill::Parameters params;
+        TrimAndFill::Workspace ws;
+        
+        // Reference values are computed by the original implementation, i.e.,
+        // re-sorting, re-ranking and refitting the truncated data on each pass
+        params.estimator = "R0";
+        auto r0 = TrimAndFill::TF(yi, vi, params, ws);
+        BOOST_TEST(r0.side == "left");
+        BOOST_TEST(r0.k0 == 9);
+        BOOST_CHECK_SMALL(r0.imputed_est - 0.122f, 1e-5f);
+        BOOST_CHECK_SMALL(r0.imputed_pval - 0.0055927f, 1e-6f);
+        
+        params.estimator = "L0";
+        auto l0 = TrimAndFill::TF(yi, vi, params, ws);
+        BOOST_TEST(l0.k0 == 6);
+        BOOST_CHECK_SMALL(l0.se_k0 - 2.0083193f, 1e-5f);
+        BOOST_CHECK_SMALL(l0.imputed_est - 0.1828782f, 1e-5f);
+        
+        // Mirrored data are filled on the other side, and the workspace can be
+        // reused for journals of different sizes
+        auto l0_flipped = TrimAndFill::TF(-1 * yi, vi, params, ws);
+        BOOST_TEST(l0_flipped.side == "right");
+        BOOST_TEST(l0_flipped.k0 == 6);
+        BOOST_CHECK_SMALL(l0_flipped.imputed_est + l0.imputed_est, 1e-5f);
+        
+        auto small = TrimAndFill::TF(yi.head(5), vi.head(5), params, ws);
+        BOOST_TEST(small.k_all == 5 + small.k0);
+    }
+
+    BOOST_AUTO_TEST_CASE( iterative_tau2_estimators )
+    {
+        arma::Row<float> yi = {0.42, 0.15, 0.71, 0.33, -0.05, 0.58, 0.27, 0.64, 0.12, 0.49};
+        arma::Row<float> vi = {0.04, 0.09, 0.02, 0.06, 0.12, 0.03, 0.08, 0.05, 0.10, 0.07};
+        
+        // Reference values are the root of Q(tau2) = k - 1, and the maxima of
+        // the (restricted) log-likelihood, found by bisection and golden
+        // section search
+        BOOST_CHECK_SMALL(RandomEffectEstimator::Tau2(yi, vi, "PM") - 0.0017306f, 1e-6f);
+        BOOST_CHECK_SMALL(RandomEffectEstimator::Tau2(yi, vi, "EB") - 0.0017306f, 1e-6f);
+        BOOST_CHECK_SMALL(RandomEffectEstimator::Tau2(yi, vi, "REML") - 0.0073004f, 1e-6f);
+        BOOST_CHECK_SMALL(RandomEffectEstimator::Tau2(yi, vi, "ML") - 0.0022218f, 1e-6f);
+        
+        // The result does not depend on the starting point
+        BOOST_CHECK_SMALL(RandomEffectEstimator::REML(yi, vi, 0) -
+                          RandomEffectEstimator::REML(yi, vi, 1), 1e-6f);
+        
+        // Homogeneous studies
+        arma::Row<float> yi_h = {0.10, 0.12, 0.11, 0.09};
+        arma::Row<float> vi_h = {0.04, 0.05, 0.03, 0.06};
+        BOOST_TEST(RandomEffectEstimator::Tau2(yi_h, vi_h, "PM") == 0);
+        BOOST_TEST(RandomEffectEstimator::Tau2(yi_h, vi_h, "REML") == 0);
+    }
+
+    BOOST_AUTO_TEST_CASE( fixed_effect_from_running_sums )
+    {
+        arma::Row<float> yi = {0.42, 0.15, 0.71, 0.33, -0.05, 0.58, 0.27, 0.64, 0.12, 0.49};
+        arma::Row<float> vi = {0.04, 0.09, 0.02, 0.06, 0.12, 0.03, 0.08, 0.05, 0.10, 0.07};
+        
+        MetaAnalysisSums sums;
+        for (arma::uword i{0}; i < yi.n_elem; ++i) {
+            sums.add(yi[i], vi[i], i % 2);
+        }
+        
+        // Studies with zero variance are left out
+        BOOST_TEST(!sums.add(0.3, 0, true));
+        BOOST_TEST(sums.k == 10);
+        BOOST_TEST(sums.n_sig == 5);
+        BOOST_TEST(sums.n_excluded == 1);
+        
+        auto fe = FixedEffectEstimator::FixedEffect(yi, vi);
+        auto fe_sums = FixedEffectEstimator::FixedEffect(sums);
+        
+        BOOST_CHECK_SMALL(fe_sums.est - fe.est, 1e-5f);
+        BOOST_CHECK_SMALL(fe_sums.se - fe.se, 1e-5f);
+        BOOST_CHECK_SMALL(fe_sums.pval - fe.pval, 1e-5f);
+        BOOST_CHECK_SMALL(fe_sums.q_stat - fe.q_stat, 1e-4f);
+        BOOST_CHECK_SMALL(fe_sums.q_pval - fe.q_pval, 1e-4f);
+        
+        BOOST_CHECK_SMALL(static_cast<float>(sums.tau2DL()) -
+                          RandomEffectEstimator::Tau2(yi, vi, "DL"), 1e-6f);
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
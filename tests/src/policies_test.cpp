@@ -37,6 +37,24 @@ BOOST_AUTO_TEST_CASE( simple_constructor ) {
 
 }
 
+BOOST_AUTO_TEST_CASE( native_and_lua_policies ) {
+
+  for (auto &def : all_possible_policies) {
+    BOOST_TEST(Policy(def, lua).is_native);
+  }
+
+  // Anything outside of the policy grammar is being handled by Lua
+  Policy lua_policy{"pvalue < 0.05 * 2", lua};
+  BOOST_TEST(not lua_policy.is_native);
+
+  arma::Row<float> data(10, arma::fill::zeros);
+  DependentVariable dv{data};
+  dv.pvalue_ = 0.07;
+
+  Policy native_policy{"pvalue < 0.1", lua};
+  BOOST_TEST(native_policy(dv) == lua_policy(dv));
+}
+
 BOOST_AUTO_TEST_SUITE_END() // FIXTURE
 
 BOOST_AUTO_TEST_SUITE( call_operator_test )
@@ -142,8 +160,29 @@ BOOST_AUTO_TEST_SUITE_END() // SUITE
 
 BOOST_AUTO_TEST_SUITE( PolicyChainTests )
 
+BOOST_FIXTURE_TEST_CASE( selections_keep_the_experiment_sorted,
+                         PoliciesVariablesAndFunctions ) {
+
+  Experiment expr;
+  for (int i{0}; i < 6; ++i) {
+    arma::Row<float> data(10, arma::fill::zeros);
+    expr.dvs_.emplace_back(data);
+    expr.dvs_.back().id_ = i;
+    expr.dvs_.back().pvalue_ = 1.f / (i + 1);
+  }
+
+  PolicyChain pchain{{"pvalue < 0.5", "random", "min(pvalue)"},
+                     PolicyChainType::Selection, lua};
+  auto selections = pchain(expr);
 
+  BOOST_TEST(selections.has_value());
+  BOOST_TEST(selections->size() == 1);
 
+  for (int i{0}; i < 6; ++i) {
+    BOOST_TEST(expr.dvs_[i].id_ == i);
+    BOOST_TEST(&expr[i] == &expr.dvs_[i]);
+  }
+}
 
 BOOST_AUTO_TEST_SUITE_END()
 
@@ -0,0 +1,60 @@
+//===-- pvalue_service_test - PValueService Unit Tests --------------------===//
+//
+// Part of the SAM Project
+// Created by Amir Masoud Abdol on 2020-11-09.
+//
+//===----------------------------------------------------------------------===//
+///
+/// @file
+/// This file contains some tests for PValueService
+///
+//===----------------------------------------------------------------------===//
+
+#define BOOST_TEST_DYN_LINK
+
+#define BOOST_TEST_MODULE PValueService Tests
+
+#include <boost/math/distributions/students_t.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include "PValueService.h"
+
+using namespace sam;
+using boost::math::students_t;
+
+BOOST_AUTO_TEST_CASE( tabulated_and_exact_tails ) {
+
+  PValueService service;
+
+  // Integer dfs are being interpolated from their tables, and the rest are
+  // being evaluated exactly
+  for (float df : {2.f, 18.f, 47.5f}) {
+    students_t dist(df);
+
+    for (int i{0}; i < 2048; ++i) {
+      double t = -20. + 40. * i / 2048;
+
+      BOOST_CHECK_SMALL(service.upperTail(t, df) - cdf(complement(dist, t)),
+                        1e-9);
+      BOOST_CHECK_SMALL(service.cdf(t, df) - cdf(dist, t), 1e-9);
+    }
+  }
+
+  BOOST_CHECK_EQUAL(service.size(), 2);
+}
+
+BOOST_AUTO_TEST_CASE( tails_do_not_depend_on_history ) {
+
+  PValueService fresh;
+  PValueService used;
+
+  for (int i{0}; i < 4096; ++i) {
+    used.upperTail(1.5, 18.f);
+  }
+  used.clear();
+  used.upperTail(0.5, 18.f);
+
+  for (double t : {-3.2, -0.7, 0.1, 1.9, 2.101}) {
+    BOOST_CHECK_EQUAL(fresh.upperTail(t, 18.f), used.upperTail(t, 18.f));
+  }
+}
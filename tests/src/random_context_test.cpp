@@ -0,0 +1,137 @@
+//===-- random_context_test - RandomContext Unit Tests --------------------===//
+//
+// Part of the SAM Project
+// Created by Amir Masoud Abdol on 2020-11-02.
+//
+//===----------------------------------------------------------------------===//
+///
+/// @file
+/// This file contains some tests for Xoshiro256 and RandomContext
+///
+//===----------------------------------------------------------------------===//
+
+#define BOOST_TEST_DYN_LINK
+
+#define BOOST_TEST_MODULE RandomContext Tests
+
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "Distributions.h"
+#include "RandomContext.h"
+#include <boost/test/unit_test.hpp>
+
+using namespace sam;
+
+BOOST_AUTO_TEST_CASE( xoshiro_jump ) {
+
+  Xoshiro256 a{42}, b{42};
+  BOOST_TEST((a == b));
+
+  b.jump();
+  BOOST_TEST((a != b));
+  BOOST_TEST(a() != b());
+}
+
+BOOST_AUTO_TEST_CASE( same_simulation_same_streams ) {
+
+  RandomContext c1{42, 7}, c2{42, 7};
+
+  for (int i{0}; i < 100; ++i) {
+    BOOST_TEST(c1[RandomStream::Data]() == c2[RandomStream::Data]());
+    BOOST_TEST(c1[RandomStream::Review]() == c2[RandomStream::Review]());
+  }
+}
+
+BOOST_AUTO_TEST_CASE( different_simulations_different_streams ) {
+
+  RandomContext c1{42, 7}, c2{42, 8}, c3{43, 7};
+
+  BOOST_TEST(c1[RandomStream::Data]() != c2[RandomStream::Data]());
+  BOOST_TEST(c1[RandomStream::Data]() != c3[RandomStream::Data]());
+
+  // Streams of one simulation are independent of each others
+  BOOST_TEST(c1[RandomStream::Data]() != c1[RandomStream::Hacking]());
+}
+
+BOOST_AUTO_TEST_CASE( simulation_replay_on_any_thread ) {
+
+  RandomContext::local().seed(42, 3);
+  auto dist = makeUnivariateDistribution(
+      {{"dist", "normal_distribution"}, {"mean", 0}, {"stddev", 1}});
+  auto worker_dist = dist;
+
+  float main_draw = dist(rng(RandomStream::Data));
+
+  float worker_draw{0};
+  std::thread worker([&]() {
+    RandomContext::local().seed(42, 3);
+    worker_draw = worker_dist(rng(RandomStream::Data));
+  });
+  worker.join();
+
+  BOOST_TEST(main_draw == worker_draw);
+}
+
+BOOST_AUTO_TEST_CASE( bulk_normal_sampling ) {
+
+  RandomContext::local().seed(42, 0);
+  auto dist = makeUnivariateDistribution(
+      {{"dist", "normal_distribution"}, {"mean", 2}, {"stddev", 3}});
+
+  std::vector<float> draws(100001);
+  dist.fill(rng(RandomStream::Data), draws.data(), draws.size());
+
+  double mean{0}, var{0};
+  for (auto x : draws) {
+    mean += x;
+  }
+  mean /= draws.size();
+  for (auto x : draws) {
+    var += (x - mean) * (x - mean);
+  }
+  var /= draws.size() - 1;
+
+  BOOST_CHECK_SMALL(mean - 2., 0.05);
+  BOOST_CHECK_SMALL(var - 9., 0.15);
+}
+
+BOOST_AUTO_TEST_CASE( simulation_replay_after_other_simulations ) {
+
+  auto dist = makeUnivariateDistribution(
+      {{"dist", "normal_distribution"}, {"mean", 0}, {"stddev", 1}});
+
+  // Odd number of draws leave a spare value in the normal distribution
+  auto replay = [&](std::uint64_t previous_simid, int n_previous_draws) {
+    RandomContext::local().seed(42, previous_simid);
+    for (int i{0}; i < n_previous_draws; ++i) {
+      dist(rng(RandomStream::Data));
+    }
+
+    RandomContext::local().seed(42, 7);
+    std::vector<float> draws(5);
+    for (auto &x : draws) {
+      x = dist(rng(RandomStream::Data));
+    }
+    return draws;
+  };
+
+  const auto first = replay(1, 3);
+  BOOST_TEST((first == replay(2, 8)));
+  BOOST_TEST((first == replay(3, 1)));
+}
+
+BOOST_AUTO_TEST_CASE( singular_covariance_factor ) {
+
+  // Perfectly correlated variables, sigma is only positive semi-definite
+  arma::Mat<float> sigma{{1, 2}, {2, 4}};
+
+  arma::Mat<float> L = covarianceFactor(sigma);
+  BOOST_TEST(arma::approx_equal(L * L.t(), sigma, "absdiff", 1e-5));
+
+  arma::Mat<float> spd{{2, 1}, {1, 2}};
+  arma::Mat<float> C = covarianceFactor(spd);
+  BOOST_TEST(arma::approx_equal(C, arma::Mat<float>(arma::chol(spd, "lower")),
+                                "absdiff", 1e-5));
+}
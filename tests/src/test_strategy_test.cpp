@@ -240,6 +240,56 @@ BOOST_FIXTURE_TEST_SUITE ( wilcox_test , SampleResearch )
 
 BOOST_AUTO_TEST_SUITE_END()
 
+BOOST_AUTO_TEST_SUITE( batched_tests )
+
+    BOOST_AUTO_TEST_CASE( t_test_batch_against_single_pairs )
+    {
+        Row<float> Sm1 = {0., 0.1, 0.2}, Sd1 = {1., 1.1, 0.9}, Sn1 = {25, 30, 40};
+        Row<float> Sm2 = {0.5, 0.2, 0.9}, Sd2 = {1., 1.3, 1.2}, Sn2 = {25, 31, 20};
+
+        for (bool equal_var : {true, false}) {
+            TestStrategy::BatchResultType res;
+            TTest::t_test_batch(Sm1, Sd1, Sn1, Sm2, Sd2, Sn2, 0.05,
+                                TestStrategy::TestAlternative::TwoSided,
+                                equal_var, res);
+
+            for (uword k{0}; k < Sm1.n_elem; ++k) {
+                auto single = equal_var
+                    ? TTest::two_samples_t_test_equal_sd(Sm1[k], Sd1[k], Sn1[k], Sm2[k], Sd2[k], Sn2[k],
+                                                         0.05, TestStrategy::TestAlternative::TwoSided)
+                    : TTest::two_samples_t_test_unequal_sd(Sm1[k], Sd1[k], Sn1[k], Sm2[k], Sd2[k], Sn2[k],
+                                                           0.05, TestStrategy::TestAlternative::TwoSided);
+
+                BOOST_CHECK_SMALL(res.stats[k] - single.tstat, 0.0001f);
+                BOOST_CHECK_SMALL(res.pvalue[k] - single.pvalue, 0.0001f);
+                BOOST_TEST(static_cast<bool>(res.sig[k]) == single.sig);
+            }
+        }
+    }
+
+    BOOST_AUTO_TEST_CASE( yuen_test_batch_against_single_pairs )
+    {
+        Row<float> a = {3.290169, 3.031275, 2.701008, 3.703762, 4.633237, 2.327662, 3.050368, 2.634829, 3.358146, 3.350406, 2.490066, 3.500233, 5.485966, 3.566797, 1.945628, 2.878948, 2.920190, 3.402363, 2.821342, 3.640249, 4.717522, 3.353228, 2.334823, 1.997572, 2.817784};
+
+        Row<float> b = {1.8461070, 1.7434951, 2.5623408, 1.2993293, 1.7287880, 1.1736090, 2.8343341, 1.0222412, 2.3009044, 1.6807970, 1.9258431, 2.3732799, 1.0147146, 1.6255013, 1.9335160, 3.2866492, 4.4683571, 2.8719037, 1.8299214, 1.5066573, 1.4453529, 0.4761787, 3.2652345};
+
+        auto [tm1, d1, h1] = YuenTest::yuen_summary(a, 0.2);
+        auto [tm2, d2, h2] = YuenTest::yuen_summary(b, 0.2);
+
+        TestStrategy::BatchResultType res;
+        YuenTest::yuen_t_test_batch({tm1}, {d1}, {h1}, {tm2}, {d2}, {h2}, 0.05,
+                                    TestStrategy::TestAlternative::TwoSided, 0, res);
+
+        auto single = YuenTest::yuen_t_test_two_samples(a, b, 0.05,
+                                    TestStrategy::TestAlternative::TwoSided, 0.2, 0.0);
+
+        BOOST_CHECK_SMALL(res.stats[0] - single.tstat, 0.0001f);
+        BOOST_CHECK_SMALL(res.df[0] - single.df, 0.0001f);
+        BOOST_CHECK_SMALL(res.pvalue[0] - single.pvalue, 0.0001f);
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
+
 //BOOST_FIXTURE_TEST_SUITE( test_strategy_class, SampleResearch )
 //
 //    BOOST_AUTO_TEST_CASE( test_strategy_constructor )